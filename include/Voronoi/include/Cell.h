@@ -2,16 +2,17 @@
 #define _CELL_H_
 
 #include "Vector2.hpp"
+#include "Real.h"
 #include "Rect.hpp"
 #include <vector>
 
 struct Cell;
 struct Site {
-    sf::Vector2<double> p;
+    Point2 p;
 	Cell* cell;
 
 	Site() {};
-	Site(sf::Vector2<double> _p, Cell* _cell) : p(_p), cell(_cell) {};
+	Site(Point2 _p, Cell* _cell) : p(_p), cell(_cell) {};
 };
 
 struct HalfEdge;
@@ -19,9 +20,11 @@ struct Cell {
 	Site site;
 	std::vector<HalfEdge*> halfEdges;
 	bool closeMe;
+	// Position in Diagram::cells, assigned by the owner once cells are final.
+	int index;
 
-	Cell() : closeMe(false) {};
-	Cell(sf::Vector2<double> _site) : site(_site, this), closeMe(false) {};
+	Cell() : closeMe(false), index(-1) {};
+	Cell(Point2 _site) : site(_site, this), closeMe(false), index(-1) {};
 
 	std::vector<Cell*> getNeighbors();
 	sf::Rect<double> getBoundingBox();
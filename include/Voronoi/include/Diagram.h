@@ -11,7 +11,7 @@ class Diagram {
 public:
 	std::vector<Cell*> cells;
 	std::vector<Edge*> edges;
-	std::vector<sf::Vector2<double>*> vertices;
+	std::vector<Point2*> vertices;
 
 	void printDiagram();
 private:
@@ -19,17 +19,17 @@ private:
 
 	std::set<Cell*> tmpCells;
 	std::set<Edge*> tmpEdges;
-	std::set<sf::Vector2<double>*> tmpVertices;
+	std::set<Point2*> tmpVertices;
 
 	MemoryPool<Cell> cellPool;
 	MemoryPool<Edge> edgePool;
 	MemoryPool<HalfEdge> halfEdgePool;
-	MemoryPool<sf::Vector2<double>> vertexPool;
+	MemoryPool<Point2> vertexPool;
 
-	sf::Vector2<double>* createVertex(double x, double y);
-	Cell* createCell(sf::Vector2<double> site);
-	Edge* createEdge(Site* lSite, Site* rSite, sf::Vector2<double>* vertA, sf::Vector2<double>* vertB);
-	Edge* createBorderEdge(Site* lSite, sf::Vector2<double>* vertA, sf::Vector2<double>* vertB);
+	Point2* createVertex(double x, double y);
+	Cell* createCell(Point2 site);
+	Edge* createEdge(Site* lSite, Site* rSite, Point2* vertA, Point2* vertB);
+	Edge* createBorderEdge(Site* lSite, Point2* vertA, Point2* vertB);
 
 	bool connectEdge(Edge* edge, sf::Rect<double> bbox);
 	bool clipEdge(Edge* edge, sf::Rect<double> bbox);
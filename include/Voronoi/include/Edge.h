@@ -2,21 +2,22 @@
 #define _EDGE_H_
 
 #include "Vector2.hpp"
+#include "Real.h"
 
 struct Site;
 
 struct Edge {
 	Site* lSite;
 	Site* rSite;
-	sf::Vector2<double>* vertA;
-	sf::Vector2<double>* vertB;
+	Point2* vertA;
+	Point2* vertB;
 
 	Edge() : lSite(nullptr), rSite(nullptr), vertA(nullptr), vertB(nullptr) {};
 	Edge(Site* _lSite, Site* _rSite) : lSite(_lSite), rSite(_rSite), vertA(nullptr), vertB(nullptr) {};
-	Edge(Site* lS, Site* rS, sf::Vector2<double>* vA, sf::Vector2<double>* vB) : lSite(lS), rSite(rS), vertA(vA), vertB(vB) {};
+	Edge(Site* lS, Site* rS, Point2* vA, Point2* vB) : lSite(lS), rSite(rS), vertA(vA), vertB(vB) {};
 
-	void setStartPoint(Site* _lSite, Site* _rSite, sf::Vector2<double>* vertex);
-	void setEndPoint(Site* _lSite, Site* _rSite, sf::Vector2<double>* vertex);
+	void setStartPoint(Site* _lSite, Site* _rSite, Point2* vertex);
+	void setEndPoint(Site* _lSite, Site* _rSite, Point2* vertex);
 };
 
 struct HalfEdge {
@@ -27,15 +28,15 @@ struct HalfEdge {
 	HalfEdge() : site(nullptr), edge(nullptr) {};
 	HalfEdge(Edge* e, Site* lSite, Site* rSite);
 
-	inline sf::Vector2<double>* startPoint();
-	inline sf::Vector2<double>* endPoint();
+	inline Point2* startPoint();
+	inline Point2* endPoint();
 };
 
-inline sf::Vector2<double>* HalfEdge::startPoint() {
+inline Point2* HalfEdge::startPoint() {
 	return (edge->lSite == site) ? edge->vertA : edge->vertB;
 }
 
-inline sf::Vector2<double> * HalfEdge::endPoint() {
+inline Point2 * HalfEdge::endPoint() {
 	return (edge->lSite == site) ? edge->vertB : edge->vertA;
 }
 
@@ -0,0 +1,17 @@
+#ifndef _REAL_H_
+#define _REAL_H_
+
+#include "Vector2.hpp"
+
+// Storage type for sites and vertices. Define VORONOI_FLOAT_GEOMETRY to
+// halve their size; breakpoints, circle events, clipping and
+// point-in-cell tests still compute in double.
+#ifdef VORONOI_FLOAT_GEOMETRY
+typedef float Real;
+#else
+typedef double Real;
+#endif
+
+typedef sf::Vector2<Real> Point2;
+
+#endif
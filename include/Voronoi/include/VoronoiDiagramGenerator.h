@@ -12,12 +12,12 @@ public:
 	VoronoiDiagramGenerator() : circleEventQueue(nullptr), siteEventQueue(nullptr), beachLine(nullptr) {};
 	~VoronoiDiagramGenerator() {};
 
-	Diagram* compute(std::vector<sf::Vector2<double>>& sites, sf::Rect<double> bbox);
+	Diagram* compute(std::vector<Point2>& sites, sf::Rect<double> bbox);
 	Diagram* relax();
 private:
 	Diagram* diagram;
 	CircleEventQueue* circleEventQueue;
-	std::vector<sf::Vector2<double>*>* siteEventQueue;
+	std::vector<Point2*>* siteEventQueue;
 	sf::Rect<double>	boundingBox;
 
 	void printBeachLine();
@@ -28,7 +28,7 @@ sf::Rect<double> Cell::getBoundingBox() {
 	double xmax = -xmin;
 	double ymax = xmax;
 
-	sf::Vector2<double>* vert;
+	Point2* vert;
 	while (edgeCount--) 
     {
 		vert = halfEdges[edgeCount]->startPoint();
@@ -75,8 +75,8 @@ int Cell::pointIntersection(double x, double y) {
 
 	while (edgeCount--) {
 		he = halfEdges[edgeCount];
-		p0 = *he->startPoint();
-		p1 = *he->endPoint();
+		p0 = sf::Vector2<double>(*he->startPoint());
+		p1 = sf::Vector2<double>(*he->endPoint());
 		r = (y - p0.y)*(p1.x - p0.x) - (x - p0.x)*(p1.y - p0.y);
 
 		if (r == 0) {
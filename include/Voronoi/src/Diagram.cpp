@@ -6,21 +6,21 @@
 using std::cout;
 using std::endl;
 
-sf::Vector2<double>* Diagram::createVertex(double x, double y) {
-	sf::Vector2<double>* vert = vertexPool.newElement(sf::Vector2<double>(x, y));
+Point2* Diagram::createVertex(double x, double y) {
+	Point2* vert = vertexPool.newElement(Point2(x, y));
 	tmpVertices.insert(vert);
 
 	return vert;
 }
 
-Cell* Diagram::createCell(sf::Vector2<double> site) {
+Cell* Diagram::createCell(Point2 site) {
 	Cell* cell = cellPool.newElement(site);
 	tmpCells.insert(cell);
 
 	return cell;
 }
 
-Edge* Diagram::createEdge(Site* lSite, Site* rSite, sf::Vector2<double>* vertA, sf::Vector2<double>* vertB) {
+Edge* Diagram::createEdge(Site* lSite, Site* rSite, Point2* vertA, Point2* vertB) {
 	Edge* edge = edgePool.newElement(Edge(lSite, rSite));
 	tmpEdges.insert(edge);
 
@@ -33,7 +33,7 @@ Edge* Diagram::createEdge(Site* lSite, Site* rSite, sf::Vector2<double>* vertA,
 	return edge;
 }
 
-Edge* Diagram::createBorderEdge(Site* lSite, sf::Vector2<double>* vertA, sf::Vector2<double>* vertB) {
+Edge* Diagram::createBorderEdge(Site* lSite, Point2* vertA, Point2* vertB) {
 	Edge* edge = edgePool.newElement(Edge(lSite, nullptr, vertA, vertB));
 	tmpEdges.insert(edge);
 
@@ -47,8 +47,8 @@ Edge* Diagram::createBorderEdge(Site* lSite, sf::Vector2<double>* vertA, sf::Vec
 //   true: the dangling endpoint could be connected
 bool Diagram::connectEdge(Edge* edge, sf::Rect<double> bbox) {
 	// skip if end point already connected
-	sf::Vector2<double>* va = edge->vertA;
-	sf::Vector2<double>* vb = edge->vertB;
+	Point2* va = edge->vertA;
+	Point2* vb = edge->vertB;
 	if (vb) { return true; }
 
 	// make local copy for speed
@@ -311,9 +311,9 @@ void Diagram::clipEdges(sf::Rect<double> bbox) {
 // Each cell refers to its associated site, and a list
 // of halfedges ordered counterclockwise.
 void Diagram::closeCells(sf::Rect<double> bbox) {
-	sf::Vector2<double>* va;
-	sf::Vector2<double>* vb;
-	sf::Vector2<double>* vz;
+	Point2* va;
+	Point2* vb;
+	Point2* vz;
 	Edge* edge;
 	std::vector<HalfEdge*>* halfEdges;
 
@@ -449,7 +449,7 @@ void Diagram::finalize() {
 	tmpEdges.clear();
 
 	vertices.reserve(tmpVertices.size());
-	for (sf::Vector2<double>* v : tmpVertices) {
+	for (Point2* v : tmpVertices) {
 		vertices.push_back(v);
 	}
 	tmpVertices.clear();
@@ -474,8 +474,8 @@ void Diagram::printDiagram() {
 		for (Cell* c : tmpCells) {
 			cout << c->site.p.x << " " << c->site.p.y << "\n" << endl;
 			for (HalfEdge* e : c->halfEdges) {
-				sf::Vector2<double>* pS = e->startPoint();
-				sf::Vector2<double>* pE = e->endPoint();
+				Point2* pS = e->startPoint();
+				Point2* pE = e->endPoint();
 
 				cout << '\t';
 				if (pS) cout << pS->x << " " << pS->y << "\n";
@@ -18,7 +18,7 @@ void VoronoiDiagramGenerator::printBeachLine() {
 	cout << endl << endl;
 }
 
-bool pointComparator(sf::Vector2<double>* a, sf::Vector2<double>* b) {
+bool pointComparator(Point2* a, Point2* b) {
 	double r = b->y - a->y;
 	if (r < 0) return true;
 	else if (r == 0) {
@@ -28,8 +28,8 @@ bool pointComparator(sf::Vector2<double>* a, sf::Vector2<double>* b) {
 	else return false;
 }
 
-Diagram* VoronoiDiagramGenerator::compute(std::vector<sf::Vector2<double>>& sites, sf::Rect<double> bbox) {
-	siteEventQueue = new std::vector<sf::Vector2<double>*>();
+Diagram* VoronoiDiagramGenerator::compute(std::vector<Point2>& sites, sf::Rect<double> bbox) {
+	siteEventQueue = new std::vector<Point2*>();
 	boundingBox = bbox;
 
 	for (size_t i = 0; i < sites.size(); ++i) {
@@ -48,7 +48,7 @@ Diagram* VoronoiDiagramGenerator::compute(std::vector<sf::Vector2<double>>& site
 	std::sort(siteEventQueue->begin(), siteEventQueue->end(), pointComparator);
 
 	// process queue
-	sf::Vector2<double>* site = siteEventQueue->empty() ? nullptr : siteEventQueue->back();
+	Point2* site = siteEventQueue->empty() ? nullptr : siteEventQueue->back();
 	if (!siteEventQueue->empty()) siteEventQueue->pop_back();
 	treeNode<CircleEvent>* circle;
 
@@ -108,7 +108,7 @@ bool halfEdgesCW(HalfEdge* e1, HalfEdge* e2) {
 }
 
 Diagram* VoronoiDiagramGenerator::relax() {
-	std::vector<sf::Vector2<double>> sites;
+	std::vector<Point2> sites;
 	std::vector<sf::Vector2<double>> verts;
 	std::vector<sf::Vector2<double>> vectors;
 	//replace each site with its cell's centroid:
@@ -123,8 +123,8 @@ Diagram* VoronoiDiagramGenerator::relax() {
 		vectors.resize(edgeCount);
 
 		for (size_t i = 0; i < edgeCount; ++i) {
-			verts[i] = *c->halfEdges[i]->startPoint();
-			vectors[i] = *c->halfEdges[i]->startPoint() - verts[0];
+			verts[i] = sf::Vector2<double>(*c->halfEdges[i]->startPoint());
+			vectors[i] = verts[i] - verts[0];
 		}
 
 		sf::Vector2<double> centroid(0.0, 0.0);
@@ -137,7 +137,7 @@ Diagram* VoronoiDiagramGenerator::relax() {
 		}
 		centroid.x /= totalArea;
 		centroid.y /= totalArea;
-		sites.push_back(centroid);
+		sites.push_back(Point2(centroid));
 	}
 
 	//then recompute the diagram using the cells' centroids
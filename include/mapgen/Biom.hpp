@@ -3,19 +3,23 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <cstring>
 
+// Names point to string literals, so copying a Biom into every region is
+// cheap; comparisons still go by name because MARK and MARK2 share one.
 struct Biom {
-  float border;
-  std::string name;
-  float feritlity;
+  float border = 0.f;
+  const char* name = "";
+  float feritlity = 0.f;
   bool operator==(const Biom& b) const {
-    return b.name == name;
+    return std::strcmp(b.name, name) == 0;
   }
   bool operator!=(const Biom& b) const {
-    return b.name != name;
+    return std::strcmp(b.name, name) != 0;
   }
   friend bool operator<(const Biom& l, const Biom& r) {
-    return l.name < r.name;
+    return std::strcmp(l.name, r.name) < 0;
   }
 };
 
@@ -68,6 +72,31 @@ const float DEFAULT_HUMIDITY = 0.f;
                                               {PRAIRIE.name, DESERT},
                                               {GRASS.name, PRAIRIE},
                                               {MEADOW.name, GRASS}}};
+
+  // BIOMS_BY_HEIGHT and BIOMS_BY_TEMP flattened into index tables, so
+  // classification is a fixed loop of compares and selects.
+  struct Classifier {
+    std::vector<Biom> bioms;
+    // Lower border, first entry in bioms and entry count - 1 per band.
+    std::vector<float> borders;
+    std::vector<int> first;
+    std::vector<int> steps;
+    // Replacement of every entry in a hot and dry climate.
+    std::vector<int> hot;
+
+    Classifier();
+    // Highest band below the height wins; humidity picks the entry, a
+    // band whose pick falls off the wet end is skipped.
+    int classify(float height, float humidity, bool isHot) const {
+      int b = 0;
+      for (size_t i = 0; i < borders.size(); i++) {
+        int n = std::min(int(steps[i] - humidity * steps[i]), steps[i]);
+        b = (height > borders[i]) & (n >= 0) ? first[i] + n : b;
+      }
+      return isHot ? hot[b] : b;
+    }
+  };
+  const Classifier &classifier();
 }
 
 #endif
@@ -9,7 +9,7 @@
 class Package;
 class City : public Location {
 public:
-  City(Region* r, std::string n, LocationType t);
+  City(Region* r, Name n, LocationType t);
   Package* makeGoods(int y);
   std::pair<int,int> buyGoods(std::vector<Package*>* goods);
   EconomyVars* economyVars = nullptr;
@@ -0,0 +1,27 @@
+#ifndef COAST_H_
+#define COAST_H_
+
+#include <vector>
+#include "mapgen/Region.hpp"
+
+namespace mg {
+  // Signed distance from every region site to the coastline along the
+  // region graph, positive on land and negative at sea. Regions touching
+  // the other side start at half the way to its nearest site and get
+  // coast[i] set. One multi-source Dijkstra per megaCluster, run in
+  // parallel; a megaCluster without a coast stays at infinity.
+  std::vector<float> coastDistance(std::vector<MegaCluster *> &clusters,
+                                   std::vector<Region *> &regions,
+                                   std::vector<char> &coast);
+
+  // Samples a field known at region sites and Voronoi vertices into a
+  // w x h grid over width x height map units. Values are interpolated
+  // linearly over the triangles between every site and its cell edges.
+  std::vector<float> rasterize(std::vector<Region *> &regions,
+                               const VertexTable &vertices,
+                               const std::vector<float> &sites,
+                               const std::vector<float> &corners, int w,
+                               int h, float width, float height);
+};
+
+#endif
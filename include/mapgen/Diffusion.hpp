@@ -0,0 +1,33 @@
+#ifndef DIFFUSION_H_
+#define DIFFUSION_H_
+
+#include <vector>
+#include "mapgen/RegionGraph.hpp"
+
+// Screened diffusion over the region graph. At the solution every free
+// region holds
+//   x[i] = (retention * source[i] + sum w[e] * x[j]) / (retention + sum w[e])
+// where e runs over the graph edges i -> j. Fixed regions keep source[i].
+struct DiffusionSystem {
+  std::vector<float> source;
+  // One weight per edge, aligned with RegionGraph::ids.
+  std::vector<float> weights;
+  std::vector<char> fixed;
+  float retention = 1.f;
+
+  void resize(const RegionGraph &graph);
+  // Double-buffered Jacobi sweeps until no region changes by more than
+  // epsilon. Returns the number of sweeps done.
+  int solve(const RegionGraph &graph, std::vector<float> &x, int maxSweeps,
+            float epsilon);
+  // Same system solved with aggregation multigrid V-cycles. Aggregates
+  // never mix regions of different groups, so moisture is not averaged
+  // across a coastline. Work per cycle is linear in the region count,
+  // however far the field has to travel. Returns the cycles done.
+  int solveMultigrid(const RegionGraph &graph, std::vector<float> &x,
+                     const std::vector<int> &group, int maxCycles,
+                     float epsilon);
+  float relax(const RegionGraph &graph, const std::vector<float> &x, int i);
+};
+
+#endif
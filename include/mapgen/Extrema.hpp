@@ -0,0 +1,28 @@
+#ifndef EXTREMA_H_
+#define EXTREMA_H_
+
+#include <vector>
+#include "mapgen/RegionGraph.hpp"
+
+namespace mg {
+  // Marks the regions with no higher neighbour. A plateau of equal
+  // neighbouring values counts once, at its lowest id, and only if no
+  // region around it is higher.
+  std::vector<char> localMaxima(const RegionGraph &graph,
+                                const std::vector<float> &field);
+  // Same for the lowest regions.
+  std::vector<char> localMinima(const RegionGraph &graph,
+                                const std::vector<float> &field);
+
+  // How far every maximum rises above the highest saddle leading to a
+  // higher one, the highest maximum of a connected graph above its lowest
+  // region. Regions that are not maxima get 0.
+  std::vector<float> prominence(const RegionGraph &graph,
+                                const std::vector<float> &field);
+
+  // Indices of the marked regions, most prominent first.
+  std::vector<int> rankExtrema(const std::vector<char> &marked,
+                               const std::vector<float> &prominence);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef HYDROLOGY_H_
+#define HYDROLOGY_H_
+
+#include <vector>
+#include "RegionGraph.hpp"
+
+// Drainage over the region graph. One priority-flood pass from the sea
+// fills depressions and gives every land region a downstream neighbour.
+class Hydrology {
+public:
+  void drain(const RegionGraph &graph, const std::vector<float> &heights,
+             const std::vector<char> &isOutlet);
+  // Stream-power incision plus hillslope creep. Every iteration drains the
+  // current heights again and updates all regions from the previous ones.
+  void erode(const RegionGraph &graph, std::vector<float> &heights,
+             const std::vector<char> &isSea, float seaLevel, int iterations);
+  // Sums runoff down the drainage graph, call after drain().
+  void accumulate(const std::vector<float> &runoff);
+  float depth(int i);
+  bool isDepression(int i);
+  bool isRiver(int i);
+  float riverThreshold();
+
+  std::vector<float> heights;
+  // Height after filling depressions up to their spill point.
+  std::vector<float> filled;
+  // Next region towards the sea, -1 for outlets.
+  std::vector<int> downstream;
+  // Outlet region every region eventually drains into.
+  std::vector<int> basin;
+  // Regions in flood order: each one comes after its downstream region.
+  std::vector<int> order;
+  // Runoff collected from every region upstream, including the region itself.
+  std::vector<float> discharge;
+
+  float lakeDepth = 0.01f;
+  // Share of all regions that has to drain through a region to form a river.
+  float riverShare = 0.0025f;
+  // Share of the drop to the downstream region cut per iteration by the
+  // smallest river, grows with the square root of discharge.
+  float erosionRate = 0.02f;
+  // Share of the difference to the neighbour mean moved per iteration.
+  float creep = 0.05f;
+};
+
+#endif
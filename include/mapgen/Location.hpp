@@ -16,9 +16,9 @@ enum LocationType {
 
 class Location {
 public:
-  Location(Region* r, std::string n, LocationType t);
+  Location(Region* r, Name n, LocationType t);
   Region* region;
-  std::string name;
+  Name name;
   LocationType type;
   std::string typeName;
 };
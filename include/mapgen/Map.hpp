@@ -2,11 +2,29 @@
 #define MAP_H_
 #include "City.hpp"
 #include "Region.hpp"
+#include "RegionGraph.hpp"
+#include "RegionHierarchy.hpp"
 #include "River.hpp"
 #include "Road.hpp"
 #include "micropather.h"
 #include <cstring>
 
+// Approximate heap footprint in bytes, split by subsystem.
+struct MemoryReport {
+  size_t regions = 0;
+  size_t clusters = 0;
+  size_t rivers = 0;
+  size_t roads = 0;
+  size_t diagram = 0;
+  size_t vertices = 0;
+  size_t names = 0;
+  size_t levels = 0;
+  size_t total() {
+    return regions + clusters + rivers + roads + diagram + vertices + names +
+           levels;
+  }
+};
+
 class Map : public micropather::Graph {
 public:
   ~Map();
@@ -17,13 +35,21 @@ public:
 
   std::vector<State *> states;
   std::vector<Region *> regions;
+  VertexTable vertices;
+  RegionGraph graph;
+  RegionHierarchy hierarchy;
   std::vector<River *> rivers;
   std::vector<City *> cities;
   std::vector<Location *> locations;
   std::vector<Road *> roads;
   std::map<std::pair<Location*, Location*>, Road*> roadMap;
+  // Every name given on this map, so that none is given twice.
+  NamePool namePool;
 
   std::string status = "";
+  Diagram *diagram = nullptr;
+
+  MemoryReport memoryReport();
 
   float getRegionDistance(Region *r, Region *r2);
   float LeastCostEstimate(void *stateStart, void *stateEnd);
@@ -8,6 +8,8 @@
 #include <memory>
 #include <random>
 
+#include "Hydrology.hpp"
+#include "Random.hpp"
 #include "Region.hpp"
 #include "Simulator.hpp"
 #include "State.hpp"
@@ -16,8 +18,7 @@
 
 typedef std::function<bool(Region *, Region *)> sameFunc;
 typedef std::function<void(Region *, Cluster *)> assignFunc;
-typedef std::function<void(Region *, Cluster *,
-                           std::map<Region *, Cluster *> *)>
+typedef std::function<void(Region *, Cluster *, std::vector<Cluster *> *)>
     reassignFunc;
 typedef std::function<Cluster *(Region *)> createFunc;
 
@@ -34,6 +35,23 @@ public:
   void setSize(int w, int h);
   void setFrequency(float freq);
   void setPointCount(int count);
+  void setErosionIterations(int iterations);
+  int getErosionIterations();
+  void setRiverTolerance(float tolerance);
+  float getRiverTolerance();
+  void setStateCount(int count);
+  int getStateCount();
+  // Levels to build; fewer come out when they stop shrinking.
+  void setLevelCount(int count);
+  int getLevelCount();
+  // Levels the current map actually has.
+  int getBuiltLevelCount();
+  // A coarser level of the region hierarchy, 0 is the finest one;
+  // nullptr for levels the map does not have.
+  const RegionLevel *getLevel(int level);
+  // Super-region of the level holding pos, -1 outside the map or for
+  // levels the map does not have.
+  int getSuperRegion(int level, sf::Vector2f pos);
   int getPointCount();
   int getOctaveCount();
   int getRelax();
@@ -44,36 +62,50 @@ public:
   std::vector<Region *> getRegions();
   void setMapTemplate(const char *t);
   void startSimulation();
+  // Runs the climate of the current map n seasons forward and returns
+  // the regions that changed biome.
+  std::vector<Region *> advanceSeasons(int n);
+  // Signed distance to the coast sampled on a w x h grid over the map,
+  // positive on land. The coastline is its zero contour.
+  std::vector<float> getCoastRaster(int w, int h);
 
   bool simpleRivers;
   bool ready;
   Map *map;
   Simulator *simulator;
   std::unique_ptr<WeatherManager> weather;
+  std::unique_ptr<Hydrology> hydrology;
 
-  template <typename Iter> Iter select_randomly(Iter start, Iter end);
+  template <typename Iter>
+  Iter select_randomly(Iter start, Iter end, mg::Random &gen);
 
-  std::mt19937 *_gen;
+  // Reseeded from the map seed on every update, stages draw from their
+  // own streams of it.
+  mg::Random _gen;
 
 private:
   void makeHeights();
   void makeDiagram();
   void makeRegions();
+  void makeErosion();
   void makeFinalRegions();
+  void classifyRegions(std::vector<int> &bioms, std::vector<float> &nice);
   void makeRivers();
   void makeClusters();
   void makeMegaClusters();
+  void makeCoast();
   void makeRelax();
   void makeRiver(Region *r);
   void calcHumidity();
   void calcTemp();
   void simplifyRivers();
   void makeBorders();
+  void makeHierarchy();
   void makeMinerals();
   void makeCities();
   void makeStates();
+  std::vector<Region *> pickCapitals(int count);
 
-  void getSea(std::vector<Region *> *seas, Region *base, Region *r);
   int _seed;
   VoronoiDiagramGenerator _vdg;
   int _pointsCount;
@@ -81,13 +113,19 @@ private:
   int _h;
   int _relax;
   int _octaves;
+  int _erosionIterations;
+  float _riverTolerance;
+  // Best places kept per landmass and city type.
+  size_t _cityCandidates;
+  int _stateCount;
+  // Classifier index every region was last given, see advanceSeasons.
+  std::vector<int> _bioms;
+  int _levelCount;
   float _freq;
   sf::Rect<double> _bbox;
-  std::vector<sf::Vector2<double>> *_sites;
-  std::map<Cell *, Region *> _cells;
+  std::vector<Point2> *_sites;
   std::unique_ptr<Diagram> _diagram;
   Cell *_highestCell;
-  std::map<Region *, Cell *> cellsMap;
   std::vector<State *> states;
 
   micropather::MicroPather *_pather;
@@ -96,9 +134,9 @@ private:
   utils::NoiseMap _mineralsMap;
   std::string _terrainType;
 
-  void genRandomSites(std::vector<sf::Vector2<double>> &sites,
+  void genRandomSites(std::vector<Point2> &sites,
                       sf::Rect<double> &bbox, unsigned int dx, unsigned int dy,
-                      unsigned int numSites);
+                      unsigned int numSites, mg::Random gen);
 
   std::vector<Cluster *> clusterize(std::vector<Region *> regions,
                                     sameFunc isSame, assignFunc assignCluster,
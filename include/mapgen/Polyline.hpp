@@ -0,0 +1,76 @@
+#ifndef POLYLINE_H_
+#define POLYLINE_H_
+
+#include <unordered_map>
+#include <vector>
+#include "mapgen/Region.hpp"
+
+namespace mg {
+  // Visvalingam-Whyatt effective area of every point of a polyline.
+  // Dropping the points below a tolerance gives the line simplified to
+  // that tolerance, so one pass serves every level of detail. The end
+  // points are never dropped.
+  std::vector<float> lineImportance(const PointList &line);
+
+  // Compacts values in place, keeping the entries whose importance is
+  // at least tolerance. Call it for the importance vector last.
+  template <typename T>
+  void keepImportant(std::vector<T> &values,
+                     const std::vector<float> &importance, float tolerance) {
+    size_t n = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+      if (importance[i] >= tolerance) {
+        values[n++] = values[i];
+      }
+    }
+    values.resize(n);
+  }
+
+  // Chains the half-edges between the regions and everything outside
+  // them into closed loops, the first point repeated at the end. Cells
+  // list their half-edges counter-clockwise, so every boundary vertex
+  // starts one boundary edge and outer borders and holes come out turning
+  // opposite ways. The map frame counts as outside.
+  template <typename F>
+  std::vector<PointList> traceBorders(const std::vector<Region *> &regions,
+                                      const std::vector<Region *> &all,
+                                      F inside) {
+    std::vector<std::pair<Point, Point>> edges;
+    for (auto r : regions) {
+      for (auto he : r->cell->halfEdges) {
+        Edge *e = he->edge;
+        Site *other = e->lSite == he->site ? e->rSite : e->lSite;
+        if (other == nullptr || !inside(all[other->cell->index])) {
+          edges.push_back({he->startPoint(), he->endPoint()});
+        }
+      }
+    }
+
+    std::unordered_map<Point, int> from;
+    from.reserve(edges.size());
+    for (int e = 0; e < int(edges.size()); e++) {
+      from.emplace(edges[e].first, e);
+    }
+    std::vector<char> used(edges.size(), 0);
+    std::vector<PointList> loops;
+    for (int e = 0; e < int(edges.size()); e++) {
+      if (used[e]) {
+        continue;
+      }
+      PointList loop;
+      int last = e;
+      for (int k = e; k != -1 && !used[k];) {
+        used[k] = 1;
+        last = k;
+        loop.push_back(edges[k].first);
+        auto it = from.find(edges[k].second);
+        k = it == from.end() ? -1 : it->second;
+      }
+      loop.push_back(edges[last].second);
+      loops.push_back(std::move(loop));
+    }
+    return loops;
+  }
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+
+namespace mg {
+  // Stages that draw random numbers, each gets its own stream.
+  enum RandomStream : uint64_t {
+    SITES_STREAM = 1,
+    WIND_STREAM,
+    CLUSTERS_STREAM,
+    RIVERS_STREAM,
+    CITIES_STREAM,
+    STATES_STREAM,
+    SIMULATION_STREAM,
+  };
+
+  // SplitMix64 finaliser.
+  inline uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  // Counter-based generator: the n-th number of a stream is a hash of the
+  // stream key and n, the same sequence SplitMix64 gives. stream() derives
+  // an independent generator for a stage or a work item, so every thread
+  // can own one and the numbers do not depend on scheduling.
+  // Satisfies UniformRandomBitGenerator, usable with <random> and
+  // std::shuffle.
+  class Random {
+  public:
+    typedef uint64_t result_type;
+
+    explicit Random(uint64_t seed = 0) : _key(mix(seed)) {}
+
+    Random stream(uint64_t id) const {
+      Random r;
+      r._key = mix(_key ^ mix(id + GOLDEN));
+      return r;
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    result_type operator()() { return mix(_key + GOLDEN * ++_counter); }
+    void discard(uint64_t n) { _counter += n; }
+
+    // Uniform in [0, 1).
+    double uniform() { return (operator()() >> 11) * 0x1.0p-53; }
+
+  private:
+    static constexpr uint64_t GOLDEN = 0x9E3779B97F4A7C15ull;
+    uint64_t _key = 0;
+    uint64_t _counter = 0;
+  };
+};
+
+#endif
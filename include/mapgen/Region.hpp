@@ -4,11 +4,11 @@
 #include <vector>
 #include "Biom.hpp"
 #include "State.hpp"
+#include "VertexTable.hpp"
 #include <VoronoiDiagramGenerator.h>
 
-typedef sf::Vector2<double>* Point;
+typedef Point2* Point;
 typedef std::vector<Point> PointList;
-typedef std::map<Point,float> HeightMap;
 
 struct Cluster;
 typedef Cluster MegaCluster;
@@ -18,42 +18,60 @@ class Location;
 class Region {
 public:
   Region();
-  Region(Biom b, PointList v, HeightMap h, Point s);
+  Region(Biom b, VertexTable *t, int cellIndex, Point s, float sh);
   PointList getPoints();
   float getHeight(Point p);
+  void setHeight(float h);
+  int getVertexCount();
+  int getVertexId(int i);
+  size_t memoryUsage();
+  // Touches the other side of the coastline, set by makeCoast.
+  bool isCoast();
+  bool isLakeCoast();
+
+  Region* getRegionWithDirection(float angle, float force);
+
+  // Fields are grouped by size to keep padding out of the layout.
   Biom biom;
   Point site;
-  bool hasRiver = false;
+  Cell* cell = nullptr;
   Cluster *cluster = nullptr;
   Cluster *stateCluster = nullptr;
   MegaCluster *megaCluster = nullptr;
-  bool border = false;
+  City* city = nullptr;
+  Location* location = nullptr;
+  State* state = nullptr;
+  std::vector<Region*> neighbors;
   float humidity = 0.f;
-  Cell* cell = nullptr;
   float temperature = 0.f;
   float minerals = 0.f;
   float nice = 0.f;
-  float windForce = 0.f;
-  City* city = nullptr;
-  std::vector<Region*> neighbors;
-  bool hasRoad = false;
+  // Water draining through the region, 1 is the smallest river.
+  float discharge = 0.f;
+  // Added to the fertility of whatever biome the region gets.
+  float fertilityBonus = 0.f;
+  // Distance to the coastline along the regions, negative at sea.
+  float coastDistance = 0.f;
   int traffic = 0;
-  Location* location = nullptr;
-  State* state = nullptr;
-  bool stateBorder = false;
-  bool seaBorder = false;
-  bool isCoast();
-  bool isLakeCoast();
+  // Same as the cell index and the position in Map::regions.
+  int id = -1;
 
-  Region* getRegionWithDirection(float angle, float force);
+  bool hasRiver : 1;
+  bool border : 1;
+  bool hasRoad : 1;
+  bool stateBorder : 1;
+  bool seaBorder : 1;
+  bool coast : 1;
 
 private:
-	PointList _verticies;
-  HeightMap _heights;
+  float _siteHeight = 0.f;
+  int _firstVertex = 0;
+  int _vertexCount = 0;
+  VertexTable *_table = nullptr;
 };
 
 struct Cluster {
-  std::string name = "";
+  Name name;
   std::vector<Region*> regions;
   std::vector<Cluster*> neighbors;
   MegaCluster* megaCluster = nullptr;
@@ -61,7 +79,10 @@ struct Cluster {
   bool hasRiver = false;;
   bool isLand = false;;
   Point* center = nullptr;
-  PointList border;
+  // Closed loops around the cluster, see MapGenerator::makeBorders.
+  std::vector<PointList> borders;
+  // lineImportance of every loop, for drawing them simplified.
+  std::vector<std::vector<float>> borderImportance;
   std::vector<Region*> resourcePoints;
   std::vector<Region*> goodPoints;
   std::vector<City*> cities;
@@ -0,0 +1,72 @@
+#ifndef REGION_GRAPH_H_
+#define REGION_GRAPH_H_
+
+#include <vector>
+#include "mapgen/Region.hpp"
+#include "mapgen/utils.hpp"
+
+struct NeighborRange {
+  const int *first;
+  const int *last;
+  const int *begin() const { return first; }
+  const int *end() const { return last; }
+  int size() const { return int(last - first); }
+};
+
+// Region adjacency in compressed sparse row form: the neighbours of
+// region i are ids[offsets[i]] .. ids[offsets[i + 1] - 1].
+struct RegionGraph {
+  std::vector<int> offsets;
+  std::vector<int> ids;
+
+  void build(std::vector<Region *> &regions);
+  int size() const { return int(offsets.size()) - 1; }
+  NeighborRange neighbors(int i) const {
+    return {ids.data() + offsets[i], ids.data() + offsets[i + 1]};
+  }
+  size_t memoryUsage();
+
+  // Splits the graph into small connected aggregates that never mix
+  // nodes of different groups. parent[i] is the aggregate of node i;
+  // returns the number of aggregates.
+  int aggregate(const std::vector<int> &group, std::vector<int> &parent) const;
+  // Graph between aggregates, every neighbour list sorted by id.
+  RegionGraph coarsen(const std::vector<int> &parent, int count) const;
+};
+
+namespace mg {
+  // Copies one attribute of every region into a flat array.
+  template <typename T, typename F>
+  std::vector<T> gather(std::vector<Region *> &regions, F f) {
+    std::vector<T> field(regions.size());
+    parallelFor(int(regions.size()), [&](int i) { field[i] = f(regions[i]); });
+    return field;
+  }
+
+  // Evaluates kernel(i, neighbours) for every region in parallel and
+  // stores the result in out[i]. Kernels must only read shared state;
+  // use char rather than bool outputs, std::vector<bool> packs bits.
+  template <typename T, typename K>
+  void stencil(const RegionGraph &graph, std::vector<T> &out, K kernel) {
+    out.resize(graph.size());
+    parallelFor(graph.size(),
+                [&](int i) { out[i] = kernel(i, graph.neighbors(i)); });
+  }
+
+  // Double-buffered iteration: every sweep reads the previous field and
+  // writes a fresh one, so the result does not depend on visiting order.
+  template <typename T, typename K>
+  void stencil(const RegionGraph &graph, std::vector<T> &field, int sweeps,
+               K kernel) {
+    std::vector<T> next(field.size());
+    for (int s = 0; s < sweeps; s++) {
+      const std::vector<T> &prev = field;
+      parallelFor(graph.size(), [&](int i) {
+        next[i] = kernel(i, graph.neighbors(i), prev);
+      });
+      field.swap(next);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef REGION_HIERARCHY_H_
+#define REGION_HIERARCHY_H_
+
+#include <vector>
+#include "mapgen/RegionGraph.hpp"
+
+// One level of detail. Super-regions merge neighbouring nodes of the
+// level below without crossing cluster borders, so every one has a single
+// cluster and biome. Attributes are means over the regions they cover.
+struct RegionLevel {
+  RegionGraph graph;
+  // Super-region of every node of the level below.
+  std::vector<int> parent;
+  // Super-region of every full-resolution region.
+  std::vector<int> of;
+  // Regions of super-region s are
+  // members[memberStart[s]] .. members[memberStart[s + 1] - 1].
+  std::vector<int> memberStart;
+  std::vector<int> members;
+
+  std::vector<Cluster *> cluster;
+  std::vector<Point2> site;
+  // Member closest to site, point queries go on from it one level down.
+  std::vector<int> center;
+  std::vector<float> height;
+  std::vector<float> humidity;
+  std::vector<float> temperature;
+  std::vector<float> minerals;
+  std::vector<float> nice;
+  // Closed loops around the super-region, simplified for its size.
+  std::vector<std::vector<PointList>> outline;
+
+  int size() const { return graph.size(); }
+};
+
+// Coarser and coarser copies of the region graph, levels[0] being the
+// finest above the regions themselves.
+class RegionHierarchy {
+public:
+  // Merges level after level until count levels exist or a level hardly
+  // shrinks any more. tolerance is the area below which outline points are
+  // dropped at full resolution; it grows with the super-region size.
+  void build(std::vector<Region *> &regions, const RegionGraph &graph,
+             int count, float tolerance);
+  // Recomputes the attributes of every level, e.g. after the climate
+  // changed.
+  void aggregate(std::vector<Region *> &regions);
+  // Region whose site is closest to p, which is the one whose cell holds
+  // it. Walks towards p on every level from the coarsest one down.
+  Region *find(std::vector<Region *> &regions, const RegionGraph &graph,
+               Point2 p) const;
+  size_t memoryUsage();
+
+  std::vector<RegionLevel> levels;
+};
+
+#endif
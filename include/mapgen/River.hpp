@@ -4,8 +4,13 @@
 #include "Region.hpp"
 
 struct River {
-  std::string name;
+  Name name;
   PointList* points;
+  // Region discharge at every point, for drawing the river width.
+  std::vector<float> discharge;
+  // Visvalingam-Whyatt area of every point, filled by simplifyRivers.
+  // Drawing only points above a threshold gives a coarser river.
+  std::vector<float> importance;
   std::vector<Region*> regions;
 };
 
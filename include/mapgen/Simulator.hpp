@@ -4,6 +4,7 @@
 #include "mapgen/Economy.hpp"
 #include "mapgen/Report.hpp"
 #include <random>
+#include "mapgen/Random.hpp"
 
 class Simulator{
 public:
@@ -37,7 +38,7 @@ private:
   bool plague = false;
 
   Map* map;
-  std::mt19937* _gen;
+  mg::Random _gen;
   int _seed;
   micropather::MicroPather* _pather;
 };
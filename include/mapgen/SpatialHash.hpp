@@ -0,0 +1,31 @@
+#ifndef SPATIAL_HASH_H_
+#define SPATIAL_HASH_H_
+
+#include <unordered_map>
+#include <vector>
+#include "mapgen/Region.hpp"
+
+// Region sites bucketed into a uniform grid. With cells about as large as
+// the query radius a query only visits the few cells around it, so
+// minimum-distance placement is near linear instead of checking every
+// region placed so far.
+class SpatialHash {
+public:
+  explicit SpatialHash(float cellSize);
+  void insert(Region *r);
+  // Any inserted region whose site is closer to p than radius.
+  bool anyWithin(Point p, float radius) const;
+  std::vector<Region *> within(Point p, float radius) const;
+  size_t size() const { return _count; }
+
+private:
+  long long key(int cx, int cy) const;
+  int cell(float v) const;
+  template <typename F> bool visit(Point p, float radius, F f) const;
+
+  float _cellSize;
+  size_t _count = 0;
+  std::unordered_map<long long, std::vector<Region *>> _cells;
+};
+
+#endif
@@ -1,12 +1,14 @@
 #ifndef STATE_H_
 #define STATE_H_
-#include <VoronoiDiagramGenerator.h>
+#include "mapgen/names.hpp"
 
+class Region;
 class State {
 public:
-  State(std::string n, Cell* c);
-  std::string name;
-  Cell* cell;
+  State(Name n, Region* c);
+  Name name;
+  // Region the state grew from.
+  Region* capital;
 };
 
 #endif
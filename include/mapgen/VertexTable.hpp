@@ -0,0 +1,31 @@
+#ifndef VERTEX_TABLE_H_
+#define VERTEX_TABLE_H_
+
+#include <vector>
+#include <VoronoiDiagramGenerator.h>
+
+typedef Point2* Point;
+class Region;
+
+// Every Voronoi vertex stored once, with per-vertex attributes.
+// Cells list their corners as a range in cellVertices.
+struct VertexTable {
+  std::vector<Point> points;
+  std::vector<float> heights;
+  std::vector<float> humidity;
+  // Signed distance to the coastline, see Region::coastDistance.
+  std::vector<float> coastDistance;
+
+  std::vector<int> cellStart;
+  std::vector<int> cellVertices;
+
+  void build(std::vector<Cell *> &cells);
+  void spreadHumidity(std::vector<Region *> &regions);
+  void spreadCoastDistance(std::vector<Region *> &regions);
+  // Moves every vertex by the mean height change of the cells around it.
+  void shiftHeights(std::vector<Region *> &regions,
+                    const std::vector<float> &delta);
+  size_t memoryUsage();
+};
+
+#endif
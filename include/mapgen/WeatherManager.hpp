@@ -1,17 +1,57 @@
 #pragma once
 #include <vector>
 #include "Region.hpp"
+#include "RegionGraph.hpp"
 #include "Biom.hpp"
+#include "Random.hpp"
+
+// Where every region takes its wind-borne share from under one wind.
+// from[i] is -1 when nothing blows into region i.
+struct WindLayer {
+  float angle = 0.f;
+  float force = 0.f;
+  std::vector<int> from;
+  std::vector<float> weight;
+
+  void build(const std::vector<Region *> &regions);
+};
 
 class WeatherManager {
 public:
     WeatherManager();
-    void calcTemp(std::vector<Region *> r);
-    void calcHumidity(std::vector<Region *> r);
-    void genWind();
+    void calcTemp(const std::vector<Region *> &r, const RegionGraph &graph);
+    void calcHumidity(const std::vector<Region *> &r,
+                      const RegionGraph &graph);
+    void genWind(const std::vector<Region *> &regions, mg::Random gen);
+    void addWind(const std::vector<Region *> &regions, float angle,
+                 float force);
+    // Moves temperature and wind on to the next season. Humidity and
+    // temperature have to be recalculated afterwards.
+    void advanceSeason(const std::vector<Region *> &regions);
 
 
+  // Current temperature swings around the mean over a year.
   float temperature = biom::DEFAULT_TEMPERATURE;
+  float meanTemperature = biom::DEFAULT_TEMPERATURE;
+  int season = 0;
+  int seasonsPerYear = 4;
+  float seasonalSwing = 5.f;
+  // How far the wind turns from its yearly mean, in degrees.
+  float seasonalTurn = 45.f;
   float windForce;
   float windAngle;
+  // Advection applies every layer in turn, the first one is genWind's.
+  std::vector<WindLayer> winds;
+
+  // Humidity diffusion: multigrid cycles are stopped early once no region
+  // changes by more than epsilon. Lower retention carries sea moisture
+  // further inland.
+  int cycles = 30;
+  float epsilon = 1e-4f;
+  float retention = 0.2f;
+  int smoothSweeps = 1;
+
+private:
+  std::vector<WindLayer> seasonWinds;
+  std::vector<float> blow(const std::vector<float> &field, float loss);
 };
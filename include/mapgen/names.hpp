@@ -1,10 +1,57 @@
 #ifndef NAMES_HPP_
 #define NAMES_HPP_
 
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include "mapgen/Random.hpp"
+
+enum NameKind : uint8_t {
+  NO_NAME,
+  RIVER_NAME,
+  LAND_NAME,
+  SEA_NAME,
+  CITY_NAME,
+  STATE_NAME
+};
+
+// A generated name is kept as the indices of its words in the lists of
+// names.cpp, the text is only put together when str() asks for it.
+struct Name {
+  NameKind kind = NO_NAME;
+  uint16_t first = 0;
+  uint16_t second = 0;
+  uint16_t third = 0;
+
+  bool empty() const { return kind == NO_NAME; }
+  uint64_t key() const {
+    return uint64_t(kind) << 48 | uint64_t(first) << 32 |
+           uint64_t(second) << 16 | third;
+  }
+  bool operator==(const Name &n) const { return key() == n.key(); }
+  std::string str() const;
+};
+
+std::ostream &operator<<(std::ostream &strm, const Name &n);
+
+// Names already given on one map. take() draws again while the name is
+// taken; only when the word lists run short does it give up and repeat.
+class NamePool {
+public:
+  Name take(Name (*draw)(mg::Random &), mg::Random &gen);
+  size_t size() const { return _used.size(); }
+  size_t memoryUsage() const;
+
+private:
+  std::unordered_set<uint64_t> _used;
+};
+
 namespace names {
-  std::string generateRiverName(std::mt19937 *gen);
-  std::string generateLandName(std::mt19937 *gen);
-  std::string generateSeaName(std::mt19937 *gen);
-  std::string generateCityName(std::mt19937 *gen);
+  Name generateRiverName(mg::Random &gen);
+  Name generateLandName(mg::Random &gen);
+  Name generateSeaName(mg::Random &gen);
+  Name generateCityName(mg::Random &gen);
+  Name generateStateName(mg::Random &gen);
 };
 #endif
@@ -1,12 +1,16 @@
 #ifndef UTILS_HPP_
 #define UTILS_HPP_
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <thread>
+#include <vector>
 #include "mapgen/City.hpp"
 
 #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
 
-typedef sf::Vector2<double>* Point;
+typedef Point2* Point;
 namespace mg {
 	template <typename T> using filterFunc = std::function<bool(T *)>;
 	template <typename T> using sortFunc = std::function<bool(T *, T *)>;
@@ -28,6 +32,62 @@ namespace mg {
   void warn(std::string prefix, int value);
   void warn(std::string prefix, City value);
 
+  // Splits [0, n) into one contiguous chunk per hardware thread and calls
+  // f(i) for every index. Chunks are fixed by n, so results written per
+  // index do not depend on scheduling.
+  template <typename F>
+  void parallelFor(int n, F f) {
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    threads = std::min(threads, std::max(1, n / 256));
+    if (threads == 1) {
+      for (int i = 0; i < n; i++) {
+        f(i);
+      }
+      return;
+    }
+    std::vector<std::thread> workers;
+    int chunk = (n + threads - 1) / threads;
+    for (int t = 0; t < threads; t++) {
+      int begin = t * chunk;
+      int end = std::min(n, begin + chunk);
+      workers.push_back(std::thread([&f](int b, int e) {
+        for (int i = b; i < e; i++) {
+          f(i);
+        }
+      }, begin, end));
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+  // Calls f(i) for every index on a pool of threads that take the next
+  // index as soon as they are free. Meant for few tasks of very different
+  // size, like one per cluster; f must only write results of task i.
+  template <typename F>
+  void parallelTasks(int n, F f) {
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    threads = std::min(threads, n);
+    if (threads <= 1) {
+      for (int i = 0; i < n; i++) {
+        f(i);
+      }
+      return;
+    }
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+      workers.push_back(std::thread([&]() {
+        for (int i = next++; i < n; i = next++) {
+          f(i);
+        }
+      }));
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
   template< typename ContainerT, typename PredicateT >
   void erase_if( ContainerT& items, const PredicateT& predicate ) {
     for( auto it = items.begin(); it != items.end(); ) {
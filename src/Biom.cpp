@@ -1 +1,28 @@
-#include "mapgen/Biom.hpp"
\ No newline at end of file
+#include "mapgen/Biom.hpp"
+
+biom::Classifier::Classifier() {
+  for (size_t i = 0; i < BIOMS.size(); i++) {
+    borders.push_back(BIOMS[i].border);
+    first.push_back(int(bioms.size()));
+    steps.push_back(int(BIOMS_BY_HEIGHT[i].size()) - 1);
+    bioms.insert(bioms.end(), BIOMS_BY_HEIGHT[i].begin(),
+                 BIOMS_BY_HEIGHT[i].end());
+  }
+  size_t count = bioms.size();
+  for (size_t i = 0; i < count; i++) {
+    hot.push_back(int(i));
+    if (BIOMS_BY_TEMP.count(bioms[i].name) != 0) {
+      hot[i] = int(bioms.size());
+      bioms.push_back(BIOMS_BY_TEMP.at(bioms[i].name));
+    }
+  }
+  hot.resize(bioms.size());
+  for (size_t i = count; i < bioms.size(); i++) {
+    hot[i] = int(i);
+  }
+}
+
+const biom::Classifier &biom::classifier() {
+  static const Classifier table;
+  return table;
+}
@@ -4,7 +4,7 @@
 #include "mapgen/Region.hpp"
 #include "mapgen/utils.hpp"
 
-City::City(Region *r, std::string n, LocationType t)
+City::City(Region *r, Name n, LocationType t)
     : Location::Location(r, n, t), isCapital(false) {
   region->city = this;
 }
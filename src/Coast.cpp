@@ -0,0 +1,114 @@
+#include "mapgen/Coast.hpp"
+#include "mapgen/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+typedef std::pair<float, int> CoastNode;
+
+std::vector<float> mg::coastDistance(std::vector<MegaCluster *> &clusters,
+                                     std::vector<Region *> &regions,
+                                     std::vector<char> &coast) {
+  std::vector<float> distance(regions.size(), INFINITY);
+  coast.assign(regions.size(), 0);
+  // Neighbours on the same side of the coast share a megaCluster, so the
+  // searches never touch each other's regions.
+  parallelTasks(int(clusters.size()), [&](int c) {
+    MegaCluster *mc = clusters[c];
+    std::priority_queue<CoastNode, std::vector<CoastNode>,
+                        std::greater<CoastNode>>
+        open;
+    for (auto r : mc->regions) {
+      for (auto n : r->neighbors) {
+        if (n->megaCluster->isLand != mc->isLand) {
+          float d = float(getDistance(r->site, n->site)) / 2;
+          distance[r->id] = std::min(distance[r->id], d);
+          coast[r->id] = 1;
+        }
+      }
+      if (coast[r->id]) {
+        open.push(std::make_pair(distance[r->id], r->id));
+      }
+    }
+
+    while (!open.empty()) {
+      CoastNode top = open.top();
+      open.pop();
+      Region *r = regions[top.second];
+      if (top.first > distance[r->id]) {
+        continue;
+      }
+      for (auto n : r->neighbors) {
+        if (n->megaCluster != mc) {
+          continue;
+        }
+        float d = top.first + float(getDistance(r->site, n->site));
+        if (d < distance[n->id]) {
+          distance[n->id] = d;
+          open.push(std::make_pair(d, n->id));
+        }
+      }
+    }
+
+    if (!mc->isLand) {
+      for (auto r : mc->regions) {
+        distance[r->id] = -distance[r->id];
+      }
+    }
+  });
+  return distance;
+}
+
+// Edge function: twice the signed area of the triangle a, b, (x, y).
+static float edgeSide(float ax, float ay, float bx, float by, float x,
+                      float y) {
+  return (bx - ax) * (y - ay) - (by - ay) * (x - ax);
+}
+
+std::vector<float> mg::rasterize(std::vector<Region *> &regions,
+                                 const VertexTable &vertices,
+                                 const std::vector<float> &sites,
+                                 const std::vector<float> &corners, int w,
+                                 int h, float width, float height) {
+  std::vector<float> raster(size_t(w) * h, 0.f);
+  float sx = w / width;
+  float sy = h / height;
+  // Pixel centers sit at half steps, triangles sharing an edge write the
+  // same interpolated value on it.
+  for (auto r : regions) {
+    float x0 = r->site->x * sx - 0.5f;
+    float y0 = r->site->y * sy - 0.5f;
+    float v0 = sites[r->id];
+    int count = r->getVertexCount();
+    for (int k = 0; k < count; k++) {
+      int a = r->getVertexId(k);
+      int b = r->getVertexId((k + 1) % count);
+      float x1 = vertices.points[a]->x * sx - 0.5f;
+      float y1 = vertices.points[a]->y * sy - 0.5f;
+      float x2 = vertices.points[b]->x * sx - 0.5f;
+      float y2 = vertices.points[b]->y * sy - 0.5f;
+      float area = edgeSide(x0, y0, x1, y1, x2, y2);
+      if (std::abs(area) < 1e-6f) {
+        continue;
+      }
+      int left = std::max(0, int(std::ceil(std::min({x0, x1, x2}))));
+      int right = std::min(w - 1, int(std::floor(std::max({x0, x1, x2}))));
+      int top = std::max(0, int(std::ceil(std::min({y0, y1, y2}))));
+      int bottom = std::min(h - 1, int(std::floor(std::max({y0, y1, y2}))));
+      for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+          float l0 = edgeSide(x1, y1, x2, y2, float(x), float(y)) / area;
+          float l1 = edgeSide(x2, y2, x0, y0, float(x), float(y)) / area;
+          float l2 = 1.f - l0 - l1;
+          if (l0 < -1e-4f || l1 < -1e-4f || l2 < -1e-4f) {
+            continue;
+          }
+          raster[size_t(y) * w + x] =
+              l0 * v0 + l1 * corners[a] + l2 * corners[b];
+        }
+      }
+    }
+  }
+  return raster;
+}
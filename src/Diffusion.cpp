@@ -0,0 +1,190 @@
+#include "mapgen/Diffusion.hpp"
+#include <algorithm>
+#include <cmath>
+
+void DiffusionSystem::resize(const RegionGraph &graph) {
+  source.assign(graph.size(), 0.f);
+  weights.assign(graph.ids.size(), 0.f);
+  fixed.assign(graph.size(), 0);
+}
+
+float DiffusionSystem::relax(const RegionGraph &graph,
+                             const std::vector<float> &x, int i) {
+  if (fixed[i]) {
+    return source[i];
+  }
+  float sum = retention * source[i];
+  float total = retention;
+  for (int e = graph.offsets[i]; e < graph.offsets[i + 1]; e++) {
+    sum += weights[e] * x[graph.ids[e]];
+    total += weights[e];
+  }
+  return total > 0.f ? sum / total : x[i];
+}
+
+int DiffusionSystem::solve(const RegionGraph &graph, std::vector<float> &x,
+                           int maxSweeps, float epsilon) {
+  int n = graph.size();
+  std::vector<float> next(n);
+  std::vector<float> change(n);
+  int sweep = 0;
+  while (sweep < maxSweeps) {
+    sweep++;
+    mg::parallelFor(n, [&](int i) {
+      next[i] = relax(graph, x, i);
+      change[i] = std::abs(next[i] - x[i]);
+    });
+    x.swap(next);
+    if (n == 0 || *std::max_element(change.begin(), change.end()) < epsilon) {
+      break;
+    }
+  }
+  return sweep;
+}
+
+namespace {
+
+// One level of the multigrid hierarchy: row i reads
+//   diag[i] * x[i] + sum off[e] * x[j] = b[i]
+// and parent maps every node to its aggregate on the next level.
+struct DiffusionLevel {
+  RegionGraph graph;
+  std::vector<float> diag;
+  std::vector<float> off;
+  std::vector<int> group;
+  std::vector<int> parent;
+};
+
+void residual(const DiffusionLevel &level, const std::vector<float> &x,
+              const std::vector<float> &b, std::vector<float> &r) {
+  const RegionGraph &g = level.graph;
+  r.resize(x.size());
+  mg::parallelFor(g.size(), [&](int i) {
+    float ax = level.diag[i] * x[i];
+    for (int e = g.offsets[i]; e < g.offsets[i + 1]; e++) {
+      ax += level.off[e] * x[g.ids[e]];
+    }
+    r[i] = b[i] - ax;
+  });
+}
+
+// Damped Jacobi, double-buffered through the residual. Without retention
+// an aggregate with no edges leaving it sums to a zero diagonal; such
+// rows have nothing to relax towards and keep their value.
+void smooth(const DiffusionLevel &level, std::vector<float> &x,
+            const std::vector<float> &b, int sweeps) {
+  std::vector<float> r;
+  for (int s = 0; s < sweeps; s++) {
+    residual(level, x, b, r);
+    mg::parallelFor(level.graph.size(), [&](int i) {
+      if (std::abs(level.diag[i]) > 1e-6f) {
+        x[i] += 0.8f * r[i] / level.diag[i];
+      }
+    });
+  }
+}
+
+DiffusionLevel coarsen(DiffusionLevel &fine) {
+  DiffusionLevel coarse;
+  int count = fine.graph.aggregate(fine.group, fine.parent);
+  coarse.graph = fine.graph.coarsen(fine.parent, count);
+  coarse.diag.assign(count, 0.f);
+  coarse.off.assign(coarse.graph.ids.size(), 0.f);
+  coarse.group.assign(count, 0);
+
+  // Galerkin product with piecewise constant interpolation: coarse
+  // coefficients are sums of the fine ones.
+  const RegionGraph &g = fine.graph;
+  const RegionGraph &cg = coarse.graph;
+  for (int i = 0; i < g.size(); i++) {
+    int pi = fine.parent[i];
+    coarse.diag[pi] += fine.diag[i];
+    coarse.group[pi] = fine.group[i];
+    for (int e = g.offsets[i]; e < g.offsets[i + 1]; e++) {
+      int pj = fine.parent[g.ids[e]];
+      if (pi == pj) {
+        coarse.diag[pi] += fine.off[e];
+        continue;
+      }
+      auto ns = cg.neighbors(pi);
+      coarse.off[std::lower_bound(ns.begin(), ns.end(), pj) - cg.ids.data()] +=
+          fine.off[e];
+    }
+  }
+  return coarse;
+}
+
+void vcycle(std::vector<DiffusionLevel> &levels, int l, std::vector<float> &x,
+            const std::vector<float> &b) {
+  DiffusionLevel &level = levels[l];
+  if (l + 1 == int(levels.size())) {
+    smooth(level, x, b, 50);
+    return;
+  }
+  smooth(level, x, b, 2);
+
+  std::vector<float> r;
+  residual(level, x, b, r);
+  std::vector<float> rc(levels[l + 1].diag.size(), 0.f);
+  for (size_t i = 0; i < r.size(); i++) {
+    rc[level.parent[i]] += r[i];
+  }
+  std::vector<float> ec(rc.size(), 0.f);
+  vcycle(levels, l + 1, ec, rc);
+  mg::parallelFor(int(x.size()), [&](int i) { x[i] += ec[level.parent[i]]; });
+
+  smooth(level, x, b, 2);
+}
+
+} // namespace
+
+int DiffusionSystem::solveMultigrid(const RegionGraph &graph,
+                                    std::vector<float> &x,
+                                    const std::vector<int> &group,
+                                    int maxCycles, float epsilon) {
+  int n = graph.size();
+  std::vector<DiffusionLevel> levels(1);
+  DiffusionLevel &top = levels[0];
+  top.graph = graph;
+  top.diag.resize(n);
+  top.off.resize(graph.ids.size());
+  top.group.resize(n);
+  std::vector<float> b(n);
+  for (int i = 0; i < n; i++) {
+    // Fixed regions only ever aggregate with each other.
+    top.group[i] = group[i] * 2 + (fixed[i] ? 1 : 0);
+    float total = retention;
+    for (int e = graph.offsets[i]; e < graph.offsets[i + 1]; e++) {
+      top.off[e] = fixed[i] ? 0.f : -weights[e];
+      total += weights[e];
+    }
+    top.diag[i] = fixed[i] ? 1.f : total;
+    b[i] = fixed[i] ? source[i] : retention * source[i];
+  }
+
+  // Coarsen until the graph stops shrinking, one node per landmass at most.
+  while (true) {
+    int size = levels.back().graph.size();
+    DiffusionLevel coarse = coarsen(levels.back());
+    if (size <= 1 || coarse.graph.size() * 10 > size * 9) {
+      break;
+    }
+    levels.push_back(std::move(coarse));
+  }
+
+  std::vector<float> prev;
+  int cycle = 0;
+  while (cycle < maxCycles) {
+    cycle++;
+    prev = x;
+    vcycle(levels, 0, x, b);
+    float change = 0.f;
+    for (int i = 0; i < n; i++) {
+      change = std::max(change, std::abs(x[i] - prev[i]));
+    }
+    if (change < epsilon) {
+      break;
+    }
+  }
+  return cycle;
+}
@@ -0,0 +1,139 @@
+#include "mapgen/Extrema.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+static const char NOT_MAXIMUM = 0;
+static const char PLATEAU = 1;
+static const char MAXIMUM = 2;
+
+std::vector<char> mg::localMaxima(const RegionGraph &graph,
+                                  const std::vector<float> &field) {
+  std::vector<char> kind;
+  stencil(graph, kind, [&](int i, NeighborRange ns) {
+    char k = MAXIMUM;
+    for (int n : ns) {
+      if (field[n] > field[i]) {
+        return NOT_MAXIMUM;
+      }
+      if (field[n] == field[i]) {
+        k = PLATEAU;
+      }
+    }
+    return k;
+  });
+
+  // Plateaus are rare, so they are resolved one after another: walk all
+  // equal regions and keep the first one if nothing around is higher.
+  std::vector<char> seen(kind.size(), 0);
+  std::vector<int> plateau;
+  for (int i = 0; i < int(kind.size()); i++) {
+    if (kind[i] != PLATEAU || seen[i]) {
+      continue;
+    }
+    bool highest = true;
+    plateau.assign(1, i);
+    seen[i] = 1;
+    for (size_t q = 0; q < plateau.size(); q++) {
+      for (int n : graph.neighbors(plateau[q])) {
+        if (field[n] > field[i]) {
+          highest = false;
+        } else if (field[n] == field[i] && !seen[n]) {
+          seen[n] = 1;
+          plateau.push_back(n);
+        }
+      }
+    }
+    for (int p : plateau) {
+      kind[p] = NOT_MAXIMUM;
+    }
+    kind[i] = highest ? MAXIMUM : NOT_MAXIMUM;
+  }
+
+  for (auto &k : kind) {
+    k = char(k == MAXIMUM);
+  }
+  return kind;
+}
+
+std::vector<char> mg::localMinima(const RegionGraph &graph,
+                                  const std::vector<float> &field) {
+  std::vector<float> negated(field.size());
+  parallelFor(int(field.size()), [&](int i) { negated[i] = -field[i]; });
+  return localMaxima(graph, negated);
+}
+
+static int findRoot(std::vector<int> &root, int i) {
+  while (root[i] != i) {
+    root[i] = root[root[i]];
+    i = root[i];
+  }
+  return i;
+}
+
+std::vector<float> mg::prominence(const RegionGraph &graph,
+                                  const std::vector<float> &field) {
+  int n = int(field.size());
+  std::vector<float> result(n, 0.f);
+  if (n == 0) {
+    return result;
+  }
+  // Regions come in from the highest down, equal ones by id, so the
+  // first region of a plateau is its peak like in localMaxima.
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    return field[a] > field[b] || (field[a] == field[b] && a < b);
+  });
+  auto higher = [&](int a, int b) {
+    return field[a] > field[b] || (field[a] == field[b] && a < b);
+  };
+
+  // Every set of connected regions above the current level knows its
+  // peak. Where two sets meet, the lower peak has found its saddle.
+  std::vector<int> root(n, -1);
+  std::vector<int> peak(n, -1);
+  for (int i : order) {
+    root[i] = i;
+    peak[i] = i;
+    for (int nb : graph.neighbors(i)) {
+      if (root[nb] == -1) {
+        continue;
+      }
+      int a = findRoot(root, i);
+      int b = findRoot(root, nb);
+      if (a == b) {
+        continue;
+      }
+      if (higher(peak[b], peak[a])) {
+        std::swap(a, b);
+      }
+      // Region i itself never is a peak once it touches a set.
+      if (peak[b] != i) {
+        result[peak[b]] = field[peak[b]] - field[i];
+      }
+      root[b] = a;
+    }
+  }
+  float lowest = field[order.back()];
+  for (int i = 0; i < n; i++) {
+    if (root[i] == i) {
+      result[peak[i]] = field[peak[i]] - lowest;
+    }
+  }
+  return result;
+}
+
+std::vector<int> mg::rankExtrema(const std::vector<char> &marked,
+                                 const std::vector<float> &prominence) {
+  std::vector<int> ranked;
+  for (int i = 0; i < int(marked.size()); i++) {
+    if (marked[i]) {
+      ranked.push_back(i);
+    }
+  }
+  std::stable_sort(ranked.begin(), ranked.end(), [&](int a, int b) {
+    return prominence[a] > prominence[b];
+  });
+  return ranked;
+}
@@ -9,11 +9,13 @@ using json = nlohmann::json;
 
 json world;
 char buff[10000000];
+MapGenerator *generator = nullptr;
 
 extern "C" {
 	__declspec(dllexport) int createMap (int seed, int w, int h) {
 
 		auto mapgen = new MapGenerator(w, h);
+		generator = mapgen;
 		mapgen->setSeed(seed);
 		mapgen->update();
 
@@ -25,7 +27,9 @@ extern "C" {
 		for (auto c : mapgen->map->clusters) {
 			auto mc = json({});
 			mc["id"] = n;
-			mc["name"] = c->name;
+			if (!c->name.empty()) {
+				mc["name"] = c->name.str();
+			}
 			mc["biom"] = c->regions.front()->biom.name;
 			mc["regions"] = c->regions.size();
 			clusters.push_back(mc);
@@ -36,7 +40,9 @@ extern "C" {
 		for (auto c : mapgen->map->megaClusters) {
 			auto mc = json({});
 			mc["id"] = n;
-			mc["name"] = c->name;
+			if (!c->name.empty()) {
+				mc["name"] = c->name.str();
+			}
 			mc["clusters"] = json::array();
 			for (auto r : c->regions)
 			{
@@ -59,13 +65,11 @@ extern "C" {
 		for (auto r : mapgen->map->regions) {
 			auto json_r = json({});
 			auto f_points = json::array();
-			auto points = r->getPoints();
-			
-			int n = 0;
-			for (PointList::iterator it2 = points.begin(); it2 < points.end();
-				it2++, n++) {
-				sf::Vector2<double> *p = points[n];
-				f_points.push_back({ {"x", p->x}, {"y", p->y}, {"height", r->getHeight(p)} });
+			auto &vertices = mapgen->map->vertices;
+			for (int n = 0; n < r->getVertexCount(); n++) {
+				int v = r->getVertexId(n);
+				Point2 *p = vertices.points[v];
+				f_points.push_back({ {"x", p->x}, {"y", p->y}, {"height", vertices.heights[v]} });
 			}
 			json_r["points"] = f_points;
 
@@ -89,6 +93,40 @@ extern "C" {
 		std::strcpy(buff, dump.c_str());
 		return dump.length() + 1;
   }
+	// Super-regions of one level of detail of the last map, read the
+	// result with getRegion like createMap's. Returns -1 without a map
+	// or for a level it does not have.
+	__declspec(dllexport) int createLevel(int l)
+	{
+		if (generator == nullptr || generator->getLevel(l) == nullptr) {
+			return -1;
+		}
+		auto &level = *generator->getLevel(l);
+		auto regions = json::array();
+		for (int s = 0; s < level.size(); s++) {
+			auto json_r = json({});
+			auto outline = json::array();
+			for (auto &loop : level.outline[s]) {
+				auto f_points = json::array();
+				for (auto p : loop) {
+					f_points.push_back({ {"x", p->x}, {"y", p->y} });
+				}
+				outline.push_back(f_points);
+			}
+			json_r["outline"] = outline;
+			json_r["site"] = { {"x", level.site[s].x}, {"y", level.site[s].y}, {"height", level.height[s]} };
+			json_r["biom"] = level.cluster[s]->biom.name;
+			json_r["isLand"] = generator->map->regions[level.center[s]]->megaCluster->isLand;
+			json_r["humidity"] = level.humidity[s];
+			json_r["temperature"] = level.temperature[s];
+			regions.push_back(json_r);
+		}
+
+		auto dump = json({ {"level", l}, {"regions", regions} }).dump();
+		std::strcpy(buff, dump.c_str());
+		return dump.length() + 1;
+	}
+
 	__declspec(dllexport) void getRegion(char *str, int n)
 	{
 		strcpy_s(str, n, buff);
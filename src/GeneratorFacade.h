@@ -5,4 +5,5 @@ using namespace std;
 extern "C" {
 	__declspec(dllexport) void getRegion(char*, int);
 	__declspec(dllexport) int createMap(int, int, int);
+	__declspec(dllexport) int createLevel(int);
 }
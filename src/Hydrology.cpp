@@ -0,0 +1,111 @@
+#include "mapgen/Hydrology.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+typedef std::pair<float, int> FloodNode;
+
+void Hydrology::drain(const RegionGraph &graph,
+                      const std::vector<float> &h,
+                      const std::vector<char> &isOutlet) {
+  int n = graph.size();
+  heights = h;
+  filled = h;
+  downstream.assign(n, -1);
+  basin.assign(n, -1);
+  order.clear();
+  order.reserve(n);
+
+  // Ties are broken by id, so the result does not depend on push order.
+  std::priority_queue<FloodNode, std::vector<FloodNode>,
+                      std::greater<FloodNode>>
+      open;
+  std::vector<char> visited(n, 0);
+  for (int i = 0; i < n; i++) {
+    if (isOutlet[i]) {
+      open.push(std::make_pair(filled[i], i));
+      visited[i] = 1;
+      basin[i] = i;
+    }
+  }
+  if (open.empty() && n > 0) {
+    int lowest = int(std::min_element(h.begin(), h.end()) - h.begin());
+    open.push(std::make_pair(filled[lowest], lowest));
+    visited[lowest] = 1;
+    basin[lowest] = lowest;
+  }
+
+  while (!open.empty()) {
+    int c = open.top().second;
+    open.pop();
+    order.push_back(c);
+    for (int nb : graph.neighbors(c)) {
+      if (visited[nb]) {
+        continue;
+      }
+      visited[nb] = 1;
+      filled[nb] = std::max(h[nb], filled[c]);
+      downstream[nb] = c;
+      basin[nb] = basin[c];
+      open.push(std::make_pair(filled[nb], nb));
+    }
+  }
+}
+
+void Hydrology::erode(const RegionGraph &graph, std::vector<float> &h,
+                      const std::vector<char> &isSea, float seaLevel,
+                      int iterations) {
+  std::vector<float> runoff(isSea.size());
+  for (size_t i = 0; i < isSea.size(); i++) {
+    runoff[i] = isSea[i] ? 0.f : 1.f;
+  }
+
+  for (int it = 0; it < iterations; it++) {
+    drain(graph, h, isSea);
+    accumulate(runoff);
+    float threshold = riverThreshold();
+    mg::stencil(graph, h, 1,
+                [&](int i, NeighborRange ns, const std::vector<float> &prev) {
+      if (isSea[i] || ns.size() == 0) {
+        return prev[i];
+      }
+      float mean = 0.f;
+      for (int n : ns) {
+        mean += prev[n];
+      }
+      mean /= float(ns.size());
+      float ht = prev[i] + creep * (mean - prev[i]);
+
+      // Implicit step towards the downstream height, so it never cuts
+      // below it whatever the discharge.
+      int d = downstream[i];
+      if (d != -1 && ht > prev[d]) {
+        float k = erosionRate * std::sqrt(discharge[i] / threshold);
+        ht = (ht + k * prev[d]) / (1.f + k);
+      }
+      return std::max(ht, seaLevel);
+    });
+  }
+}
+
+void Hydrology::accumulate(const std::vector<float> &runoff) {
+  discharge = runoff;
+  // Reverse flood order visits every region before its downstream one.
+  for (auto it = order.rbegin(); it != order.rend(); it++) {
+    int d = downstream[*it];
+    if (d != -1) {
+      discharge[d] += discharge[*it];
+    }
+  }
+}
+
+float Hydrology::depth(int i) { return filled[i] - heights[i]; }
+
+bool Hydrology::isDepression(int i) { return depth(i) > lakeDepth; }
+
+float Hydrology::riverThreshold() {
+  return std::max(1.f, riverShare * float(discharge.size()));
+}
+
+bool Hydrology::isRiver(int i) { return discharge[i] >= riverThreshold(); }
@@ -1,6 +1,6 @@
 #include "mapgen/Location.hpp"
 
-Location::Location(Region *r, std::string n, LocationType t) : region(r), name(n), type(t) {
+Location::Location(Region *r, Name n, LocationType t) : region(r), name(n), type(t) {
   region->location = this;
 
   switch (this->type) {
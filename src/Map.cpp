@@ -69,3 +69,76 @@ void Map::AdjacentCost(void *state,
 };
 void Map::PrintStateInfo(void *state){};
 
+static size_t clusterMemory(Cluster *c) {
+  size_t loops = 0;
+  for (auto &l : c->borders) {
+    loops += l.capacity() * sizeof(Point);
+  }
+  for (auto &l : c->borderImportance) {
+    loops += l.capacity() * sizeof(float);
+  }
+  return loops + sizeof(Cluster) + c->regions.capacity() * sizeof(Region *) +
+         c->neighbors.capacity() * sizeof(Cluster *) +
+         c->borders.capacity() * sizeof(PointList) +
+         c->borderImportance.capacity() * sizeof(std::vector<float>) +
+         c->resourcePoints.capacity() * sizeof(Region *) +
+         c->goodPoints.capacity() * sizeof(Region *) +
+         c->cities.capacity() * sizeof(City *) +
+         c->states.capacity() * sizeof(State *);
+}
+
+static size_t roadMemory(Road *r) {
+  return sizeof(Road) + r->regions.capacity() * sizeof(Region *);
+}
+
+MemoryReport Map::memoryReport() {
+  MemoryReport report;
+  report.regions = regions.capacity() * sizeof(Region *) + graph.memoryUsage();
+  for (auto r : regions) {
+    report.regions += r->memoryUsage();
+  }
+
+  for (auto clusterList : {&megaClusters, &clusters, &stateClusters}) {
+    report.clusters += clusterList->capacity() * sizeof(Cluster *);
+    for (auto c : *clusterList) {
+      report.clusters += clusterMemory(c);
+    }
+  }
+
+  report.rivers = rivers.capacity() * sizeof(River *);
+  for (auto r : rivers) {
+    report.rivers += sizeof(River) + r->regions.capacity() * sizeof(Region *) +
+                     (r->discharge.capacity() + r->importance.capacity()) *
+                         sizeof(float);
+    if (r->points != nullptr) {
+      report.rivers += sizeof(PointList) + r->points->capacity() * sizeof(Point);
+    }
+  }
+
+  report.roads = roads.capacity() * sizeof(Road *);
+  for (auto r : roads) {
+    report.roads += roadMemory(r);
+  }
+  // Map nodes carry three pointers and a color next to the value. The
+  // roads themselves are counted above.
+  for (const auto &p : roadMap) {
+    report.roads += sizeof(p) + 4 * sizeof(void *);
+  }
+
+  if (diagram != nullptr) {
+    report.diagram = diagram->cells.capacity() * sizeof(Cell *) +
+                     diagram->edges.capacity() * sizeof(Edge *) +
+                     diagram->vertices.capacity() * sizeof(Point);
+    for (auto c : diagram->cells) {
+      report.diagram += sizeof(Cell) + c->halfEdges.capacity() *
+                                           (sizeof(HalfEdge *) + sizeof(HalfEdge));
+    }
+    report.diagram += diagram->edges.size() * sizeof(Edge) +
+                      diagram->vertices.size() * sizeof(Point2);
+  }
+  report.vertices = vertices.memoryUsage();
+  report.names = namePool.memoryUsage();
+  report.levels = hierarchy.memoryUsage();
+  return report;
+}
+
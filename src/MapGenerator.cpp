@@ -1,13 +1,21 @@
 #include "mapgen/MapGenerator.hpp"
 #include "mapgen/Biom.hpp"
+#include "mapgen/Coast.hpp"
+#include "mapgen/Extrema.hpp"
 #include "mapgen/Map.hpp"
 #include "mapgen/names.hpp"
+#include "mapgen/Polyline.hpp"
+#include "mapgen/SpatialHash.hpp"
 #include "mapgen/utils.hpp"
 #include "rang.hpp"
 #include <VoronoiDiagramGenerator.h>
+#include <cmath>
 #include <iterator>
 #include <random>
 #include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
 
 template <typename T> using filterFunc = std::function<bool(T *)>;
 template <typename T> using sortFunc = std::function<bool(T *, T *)>;
@@ -26,8 +34,8 @@ std::vector<T *> filterObjects(std::vector<T *> regions, filterFunc<T> filter,
 const int DEFAULT_RELAX = 5;
 
 bool cellsOrdered(Cell *c1, Cell *c2) {
-  sf::Vector2<double> s1 = c1->site.p;
-  sf::Vector2<double> s2 = c2->site.p;
+  Point2 s1 = c1->site.p;
+  Point2 s2 = c2->site.p;
   if (s1.y < s2.y)
     return true;
   if (s1.y == s2.y && s1.x < s2.x)
@@ -35,8 +43,7 @@ bool cellsOrdered(Cell *c1, Cell *c2) {
   return false;
 }
 
-bool sitesOrdered(const sf::Vector2<double> &s1,
-                  const sf::Vector2<double> &s2) {
+bool sitesOrdered(const Point2 &s1, const Point2 &s2) {
   if (s1.y < s2.y)
     return true;
   if (s1.y == s2.y && s1.x < s2.x)
@@ -51,61 +58,197 @@ bool clusterOrdered(Cluster *s1, Cluster *s2) {
 }
 
 template <typename Iter>
-Iter MapGenerator::select_randomly(Iter start, Iter end) {
+Iter MapGenerator::select_randomly(Iter start, Iter end, mg::Random &gen) {
   std::uniform_int_distribution<> dis(0, std::distance(start, end) - 1);
-  std::advance(start, dis(*_gen));
+  std::advance(start, dis(gen));
   return start;
 }
 
-MapGenerator::MapGenerator(int w, int h) : _w(w), _h(h) {
+MapGenerator::MapGenerator(int w, int h) : _seed(0), _w(w), _h(h) {
   _vdg = VoronoiDiagramGenerator();
   _pointsCount = 10000;
   _octaves = 4;
+  _erosionIterations = 10;
+  _riverTolerance = 0.2f;
+  _cityCandidates = 100;
+  _stateCount = 2;
+  _levelCount = 4;
   _freq = 0.3;
   _relax = DEFAULT_RELAX;
   simpleRivers = true;
   _terrainType = "basic";
   map = nullptr;
   simulator = nullptr;
-  _gen = new std::mt19937(_seed);
+}
+
+namespace {
+
+// Cost of a state growing from one region into the next: distance,
+// made longer by climbing, mountains and rivers, which make natural
+// frontiers. Crossing the sea is the slowest of all.
+float growthCost(Region *from, Region *to) {
+  float cost = float(mg::getDistance(from->site, to->site));
+  cost *= 1.f + 10.f * std::abs(to->getHeight(to->site) -
+                                from->getHeight(from->site));
+  if (to->biom == biom::ROCK || to->biom == biom::SNOW ||
+      to->biom == biom::ICE) {
+    cost *= 2.f;
+  }
+  if (to->hasRiver != from->hasRiver) {
+    cost *= 2.f;
+  }
+  if (!to->megaCluster->isLand) {
+    cost *= 4.f;
+  }
+  return cost;
+}
+
+typedef std::pair<float, int> GrowthNode;
+
+// Multi-source Dijkstra from the regions already owned in state[],
+// claiming regions for the nearest owner. Only regions for which
+// canEnter is true are entered, claimed ones are never taken over.
+template <typename F>
+void growStates(std::vector<Region *> &regions, std::vector<Region *> &seeds,
+                std::vector<float> &cost, std::vector<State *> &state,
+                F canEnter) {
+  std::priority_queue<GrowthNode, std::vector<GrowthNode>,
+                      std::greater<GrowthNode>>
+      open;
+  for (auto r : seeds) {
+    open.push(std::make_pair(cost[r->id], r->id));
+  }
+  while (!open.empty()) {
+    GrowthNode top = open.top();
+    open.pop();
+    Region *r = regions[top.second];
+    if (top.first > cost[r->id]) {
+      continue;
+    }
+    for (auto n : r->neighbors) {
+      if (!canEnter(n)) {
+        continue;
+      }
+      float c = top.first + growthCost(r, n);
+      if (c < cost[n->id]) {
+        cost[n->id] = c;
+        state[n->id] = state[r->id];
+        open.push(std::make_pair(c, n->id));
+      }
+    }
+  }
+}
+
+} // namespace
+
+// Capitals spread over the map by farthest-point sampling: cities when
+// there are enough of them, any land region otherwise.
+std::vector<Region *> MapGenerator::pickCapitals(int count) {
+  std::vector<Region *> places;
+  for (auto c : map->cities) {
+    places.push_back(c->region);
+  }
+  if (int(places.size()) < count) {
+    places.clear();
+    for (auto r : map->regions) {
+      if (r->megaCluster->isLand) {
+        places.push_back(r);
+      }
+    }
+  }
+  std::sort(places.begin(), places.end(),
+            [](Region *a, Region *b) { return a->id < b->id; });
+
+  std::vector<Region *> capitals;
+  if (count <= 0 || places.size() == 0) {
+    return capitals;
+  }
+  auto gen = _gen.stream(mg::STATES_STREAM);
+  capitals.push_back(*select_randomly(places.begin(), places.end(), gen));
+  std::vector<double> nearest(places.size());
+  mg::parallelFor(int(places.size()), [&](int i) {
+    nearest[i] = mg::getDistance(places[i]->site, capitals[0]->site);
+  });
+  while (int(capitals.size()) < std::min(count, int(places.size()))) {
+    int far = int(std::max_element(nearest.begin(), nearest.end()) -
+                  nearest.begin());
+    Region *capital = places[far];
+    capitals.push_back(capital);
+    mg::parallelFor(int(places.size()), [&](int i) {
+      nearest[i] = std::min(nearest[i],
+                            mg::getDistance(places[i]->site, capital->site));
+    });
+  }
+  return capitals;
 }
 
 void MapGenerator::makeStates() {
   map->status = "Making states...";
   map->stateClusters.clear();
 
-  _bbox = sf::Rect<double>(0, 0, _w, _h);
-  VoronoiDiagramGenerator vdg;
-  auto sites = new std::vector<sf::Vector2<double>>();
-  genRandomSites(*sites, _bbox, _w, _h, 2);
-  std::unique_ptr<Diagram> diagram;
-  diagram.reset(vdg.compute(*sites, _bbox));
-
-  int n = 0;
-  for (auto c : diagram->cells) {
-    State *s = new State(
-        (n == 0 ? "Blue empire" : "Red lands"), c);
+  int n = int(map->regions.size());
+  std::vector<float> cost(n, INFINITY);
+  std::vector<State *> owner(n, nullptr);
+  std::vector<std::vector<Region *>> seeds(map->megaClusters.size());
+  for (auto capital : pickCapitals(_stateCount)) {
+    auto gen = _gen.stream(mg::STATES_STREAM).stream(capital->id);
+    State *s = new State(map->namePool.take(names::generateStateName, gen),
+                         capital);
     map->states.push_back(s);
-    n++;
+    cost[capital->id] = 0.f;
+    owner[capital->id] = s;
+    auto mc = std::find(map->megaClusters.begin(), map->megaClusters.end(),
+                        capital->megaCluster);
+    seeds[mc - map->megaClusters.begin()].push_back(capital);
   }
 
+  // Landmasses do not share regions, so each one grows on its own task.
+  mg::parallelTasks(int(map->megaClusters.size()), [&](int i) {
+    Cluster *mc = map->megaClusters[i];
+    growStates(map->regions, seeds[i], cost, owner,
+               [&](Region *r) { return r->megaCluster == mc; });
+  });
+
+  // Landmasses without a capital go to whoever reaches them first by sea.
+  std::vector<Region *> owned;
+  std::vector<char> settled(n, 0);
   for (auto r : map->regions) {
-    if (!r->megaCluster->isLand) {
+    if (owner[r->id] != nullptr) {
+      owned.push_back(r);
+      settled[r->id] = 1;
+    }
+  }
+  growStates(map->regions, owned, cost, owner, [&](Region *r) {
+    return !r->megaCluster->isLand || !settled[r->id];
+  });
+  // The cheapest region of such a landmass is where the first state
+  // landed; the whole landmass goes to it rather than being split.
+  for (auto mc : map->megaClusters) {
+    if (!mc->isLand || mc->regions.empty() ||
+        settled[mc->regions.front()->id]) {
       continue;
     }
-    for (auto s : map->states) {
-      if (s->cell->pointIntersection(r->site->x, r->site->y) != -1) {
-        r->state = s;
-        auto ms = r->megaCluster->states;
-        if (std::count(ms.begin(), ms.end(), s) == 0) {
-          r->megaCluster->states.push_back(s);
-        }
-        auto cs = r->cluster->states;
-        if (std::count(cs.begin(), cs.end(), s) == 0) {
-          r->cluster->states.push_back(s);
-        }
-        break;
-      }
+    auto first = *std::min_element(
+        mc->regions.begin(), mc->regions.end(),
+        [&](Region *a, Region *b) { return cost[a->id] < cost[b->id]; });
+    for (auto r : mc->regions) {
+      owner[r->id] = owner[first->id];
+    }
+  }
+
+  for (auto r : map->regions) {
+    if (!r->megaCluster->isLand || owner[r->id] == nullptr) {
+      continue;
+    }
+    State *s = owner[r->id];
+    r->state = s;
+    auto &ms = r->megaCluster->states;
+    if (std::count(ms.begin(), ms.end(), s) == 0) {
+      ms.push_back(s);
+    }
+    auto &cs = r->cluster->states;
+    if (std::count(cs.begin(), cs.end(), s) == 0) {
+      cs.push_back(s);
     }
   }
 
@@ -125,7 +268,7 @@ void MapGenerator::makeStates() {
         }
       },
       [&](Region *rn, Cluster *knownCluster,
-          std::map<Region *, Cluster *> *_clusters) {
+          std::vector<Cluster *> *_clusters) {
         Cluster *oldCluster = rn->stateCluster;
         rn->stateCluster = knownCluster;
         if (std::find(knownCluster->regions.begin(),
@@ -140,7 +283,7 @@ void MapGenerator::makeStates() {
             if (std::find(kcrn.begin(), kcrn.end(), orn) == kcrn.end()) {
               knownCluster->regions.push_back(orn);
             }
-            (*_clusters)[orn] = knownCluster;
+            (*_clusters)[orn->id] = knownCluster;
           }
           oldCluster->regions.clear();
         }
@@ -163,68 +306,34 @@ void MapGenerator::makeStates() {
                           }),
            sc.end());
   map->stateClusters.assign(sc.begin(), sc.end());
-  sc.clear();
-
-
-  for (auto sc : map->stateClusters) {
-    if (sc->regions.size() < 200) {
-      StateCluster *oc = nullptr;
-
-      for (auto r : sc->regions) {
-        for (auto n : r->neighbors) {
-          if (n->stateCluster != nullptr && n->stateCluster != r->stateCluster && n->stateCluster) {
-            oc = n->stateCluster;
-            break;
-          }
-        }
-        if (oc != nullptr) {
-          break;
-        }
-      }
-      if (oc == nullptr || oc->regions.size() <= 0) {
-        continue;
-      }
-
-      if (oc->regions.size() > 4 * sc->regions.size() || (sc->regions.size() < 50 && oc->regions.size() >= sc->regions.size())) {
-        mg::info("State Corrections size:", sc->regions.size());
-        auto oldState = sc->states[0];
-        mg::info("State Corrections from:", oldState->name);
-        auto newState = oc->states[0];
-        mg::info("State Corrections to:", newState->name);
-        for (auto r : sc->regions) {
-          r->state = newState;
-          oc->regions.push_back(r);
-          r->stateCluster = oc;
-        }
-        sc->regions.clear();
-      }
-    }
-  }
-
-  map->stateClusters.erase(
-      std::remove_if(map->stateClusters.begin(), map->stateClusters.end(),
-                     [&](Cluster *c) {
-                       return c->regions.size() == 0 || c->states.size() == 0;
-                     }),
-      map->stateClusters.end());
+  mg::info("States:", int(map->states.size()));
+  mg::info("State clusters:", int(map->stateClusters.size()));
 
-  for (auto r : map->regions) {
+  // Bit 0: touches another state, bit 1: every such neighbour is sea.
+  std::vector<char> borders;
+  mg::stencil(map->graph, borders, [&](int i, NeighborRange ns) {
+    Region *r = map->regions[i];
     if (!r->megaCluster->isLand) {
-      continue;
+      return char(0);
     }
-
     int sn = 0;
     int en = 0;
-    for (auto n : r->neighbors) {
-      if (n->state != r->state) {
-        r->stateBorder = true;
+    for (int n : ns) {
+      Region *rn = map->regions[n];
+      if (rn->state != r->state) {
         en++;
-        if (!n->megaCluster->isLand) {
+        if (!rn->megaCluster->isLand) {
           sn++;
         }
       }
     }
-    if (sn == en) {
+    return char((en != 0 ? 1 : 0) | (sn == en ? 2 : 0));
+  });
+  for (auto r : map->regions) {
+    if (borders[r->id] & 1) {
+      r->stateBorder = true;
+    }
+    if (borders[r->id] & 2) {
       r->seaBorder = true;
     }
   }
@@ -232,49 +341,27 @@ void MapGenerator::makeStates() {
 
 void MapGenerator::simplifyRivers() {
   map->status = "Simplify rivers...";
-  for (auto r : map->rivers) {
-    PointList *rvr = r->points;
-    PointList sr;
-    int c = rvr->size();
-    int i = 0;
-    sr.push_back((*rvr)[0]);
-    for (PointList::iterator it = rvr->begin(); it < rvr->end(); it++, i++) {
-      Point p = (*rvr)[i];
-	  if (i == rvr->size() - 1) {
-		  break;
-	  }
-      Point p2 = (*rvr)[i + 1];
-      if (c - i - 1 < 2) {
-        break;
-      }
-
-      Point p3 = (*rvr)[i + 2];
-      Point sp;
-
-      double d1 = mg::getDistance(p, p2);
-      double d2 = mg::getDistance(p, p3);
-
-      if (d2 < d1) {
-        sp = p2;
-      } else {
-        sp = p3;
-        i++;
-      }
-
-      sr.push_back(sp);
-    }
-
-    rvr->clear();
-    rvr->reserve(sr.size());
-    i = 0;
-    for (PointList::iterator it = sr.begin(); it < sr.end(); it++, i++) {
-      Point p(sr[i]);
-      if (p->x <= 0.f || p->x != p->x || p->y <= 0.f || p->y != p->y) {
-        continue;
-      }
-      rvr->push_back(sr[i]);
+  // Tolerance is given in mean region areas.
+  float tolerance = _riverTolerance * float(_w) * float(_h) / _pointsCount;
+  // Rivers are few and very uneven in length, so each is its own task.
+  mg::parallelTasks(int(map->rivers.size()), [&](int i) {
+    River *r = map->rivers[i];
+    PointList &rvr = *r->points;
+    std::vector<float> valid(rvr.size());
+    for (size_t k = 0; k < rvr.size(); k++) {
+      Point p = rvr[k];
+      valid[k] = p->x <= 0.f || p->x != p->x || p->y <= 0.f || p->y != p->y
+                     ? 0.f
+                     : 1.f;
     }
-  }
+    mg::keepImportant(r->discharge, valid, 1.f);
+    mg::keepImportant(rvr, valid, 1.f);
+
+    r->importance = mg::lineImportance(rvr);
+    mg::keepImportant(r->discharge, r->importance, tolerance);
+    mg::keepImportant(rvr, r->importance, tolerance);
+    mg::keepImportant(r->importance, r->importance, tolerance);
+  });
 }
 
 void MapGenerator::makeRelax() {
@@ -306,6 +393,26 @@ void MapGenerator::setFrequency(float f) { _freq = f; }
 
 void MapGenerator::setPointCount(int c) { _pointsCount = c; }
 
+int MapGenerator::getErosionIterations() { return _erosionIterations; }
+
+void MapGenerator::setErosionIterations(int i) { _erosionIterations = i; }
+
+float MapGenerator::getRiverTolerance() { return _riverTolerance; }
+
+void MapGenerator::setRiverTolerance(float t) { _riverTolerance = t; }
+
+int MapGenerator::getStateCount() { return _stateCount; }
+
+void MapGenerator::setStateCount(int c) { _stateCount = c; }
+
+int MapGenerator::getLevelCount() { return _levelCount; }
+
+void MapGenerator::setLevelCount(int c) { _levelCount = c; }
+
+int MapGenerator::getBuiltLevelCount() {
+  return map == nullptr ? 0 : int(map->hierarchy.levels.size());
+}
+
 //TODO: add "light" for applying new weather
 void MapGenerator::update() {
   ready = false;
@@ -315,36 +422,115 @@ void MapGenerator::update() {
   }
 
   map = new Map();
+  _gen = mg::Random(_seed);
   simulator = new Simulator(map, _seed);
   weather = std::make_unique<WeatherManager>();
+  hydrology = std::make_unique<Hydrology>();
   makeHeights();
   makeDiagram();
 
   makeRegions();
+  makeErosion();
   makeMegaClusters();
+  makeCoast();
 
   makeRivers();
   if (simpleRivers) {
     simplifyRivers();
   }
-  weather->genWind();
+  weather->genWind(map->regions, _gen.stream(mg::WIND_STREAM));
   map->status = "Making world moist...";
-  weather->calcHumidity(map->regions);
+  weather->calcHumidity(map->regions, map->graph);
+  map->vertices.spreadHumidity(map->regions);
   map->status = "Making world cool...";
-  weather->calcTemp(map->regions);
+  weather->calcTemp(map->regions, map->graph);
 
   makeMinerals();
-  makeBorders();
 
   makeFinalRegions();
   makeClusters();
+  makeBorders();
+  makeHierarchy();
 
   makeCities();
   makeStates();
 
+  auto memory = map->memoryReport();
+  mg::info("Memory, regions (kb):", int(memory.regions / 1024));
+  mg::info("Memory, clusters (kb):", int(memory.clusters / 1024));
+  mg::info("Memory, rivers (kb):", int(memory.rivers / 1024));
+  mg::info("Memory, roads (kb):", int(memory.roads / 1024));
+  mg::info("Memory, diagram (kb):", int(memory.diagram / 1024));
+  mg::info("Memory, vertices (kb):", int(memory.vertices / 1024));
+  mg::info("Memory, names (kb):", int(memory.names / 1024));
+  mg::info("Memory, levels (kb):", int(memory.levels / 1024));
+
   ready = true;
 }
 
+void MapGenerator::makeCoast() {
+  map->status = "Measuring coastline...";
+  std::vector<char> coast;
+  auto distance = mg::coastDistance(map->megaClusters, map->regions, coast);
+  // Sequential, coast shares its byte with the other flags.
+  for (auto r : map->regions) {
+    r->coastDistance = distance[r->id];
+    r->coast = coast[r->id] != 0;
+  }
+  map->vertices.spreadCoastDistance(map->regions);
+}
+
+std::vector<float> MapGenerator::getCoastRaster(int w, int h) {
+  auto sites = mg::gather<float>(map->regions,
+                                 [](Region *r) { return r->coastDistance; });
+  return mg::rasterize(map->regions, map->vertices, sites,
+                       map->vertices.coastDistance, w, h, float(_w),
+                       float(_h));
+}
+
+std::vector<Region *> MapGenerator::advanceSeasons(int n) {
+  std::vector<char> changed(map->regions.size(), 0);
+  for (int s = 0; s < n; s++) {
+    weather->advanceSeason(map->regions);
+    map->status = "Changing seasons...";
+    weather->calcHumidity(map->regions, map->graph);
+    weather->calcTemp(map->regions, map->graph);
+
+    // The mean temperature moves the hot border every season, so every
+    // region is classified again; only regions whose classifier entry
+    // changed get a new biome.
+    std::vector<int> bioms;
+    std::vector<float> nice;
+    classifyRegions(bioms, nice);
+    auto &table = biom::classifier();
+    mg::parallelFor(int(map->regions.size()), [&](int i) {
+      Region *r = map->regions[i];
+      if (r->biom == biom::LAKE) {
+        return;
+      }
+      r->nice = nice[i];
+      if (bioms[i] != _bioms[i]) {
+        _bioms[i] = bioms[i];
+        r->biom = table.bioms[bioms[i]];
+        r->biom.feritlity += r->fertilityBonus;
+        changed[i] = 1;
+      }
+    });
+  }
+  map->vertices.spreadHumidity(map->regions);
+  map->hierarchy.aggregate(map->regions);
+
+  std::vector<Region *> regions;
+  for (auto r : map->regions) {
+    if (changed[r->id]) {
+      regions.push_back(r);
+    }
+  }
+  mg::info("Season:", weather->season);
+  mg::info("Biomes changed:", int(regions.size()));
+  return regions;
+}
+
 void MapGenerator::startSimulation() {
   map->status = "";
   ready = false;
@@ -352,207 +538,201 @@ void MapGenerator::startSimulation() {
   ready = true;
 }
 
-void MapGenerator::getSea(std::vector<Region *> *seas, Region *base,
-                          Region *r) {
+// Whether fewer than limit sea regions can be reached from the coastal
+// region r through sea regions closer to it than radius (plus one ring
+// beyond them). Connected sea bodies are the sea megaClusters, so when
+// the ones touching r are small enough no search is needed. Otherwise a
+// breadth-first search stops as soon as limit is reached. Only touches
+// local state, so candidates can be checked in parallel.
+static bool isSmallSea(Region *r, float radius, int limit) {
+  int basins = 0;
+  std::vector<Cluster *> seen;
   for (auto n : r->neighbors) {
     if (!n->megaCluster->isLand &&
-        std::find(seas->begin(), seas->end(), n) == seas->end()) {
-      seas->push_back(n);
-      float d = mg::getDistance(base->site, n->site);
-      if (d < 100) {
-        getSea(seas, base, n);
+        std::find(seen.begin(), seen.end(), n->megaCluster) == seen.end()) {
+      seen.push_back(n->megaCluster);
+      basins += int(n->megaCluster->regions.size());
+    }
+  }
+  if (basins < limit) {
+    return true;
+  }
+
+  std::unordered_set<int> visited;
+  visited.reserve(limit);
+  std::vector<Region *> queue;
+  queue.push_back(r);
+  for (size_t q = 0; q < queue.size(); q++) {
+    for (auto n : queue[q]->neighbors) {
+      if (n->megaCluster->isLand || !visited.insert(n->id).second) {
+        continue;
+      }
+      if (int(visited.size()) >= limit) {
+        return false;
+      }
+      if (mg::getDistance(r->site, n->site) < radius) {
+        queue.push_back(n);
       }
     }
   }
-};
+  return true;
+}
 
-void MapGenerator::makeCities() {
-  map->status = "Founding cities...";
+namespace {
 
-  std::vector<Region *> places;
+// A place for a city of some type, better ones come first.
+struct Candidate {
+  float score;
+  int position;
+  Region *region;
+  bool operator<(const Candidate &c) const {
+    return score > c.score || (score == c.score && position < c.position);
+  }
+};
 
-  std::vector<Region *> cache;
-  for (auto mc : map->megaClusters) {
-    if (!mc->isLand) {
+// The k best scored regions of a cluster, best first. Ties keep the
+// cluster order. Unscored regions carry -infinity.
+std::vector<Candidate> topCandidates(Cluster *cluster,
+                                     const std::vector<float> &score,
+                                     size_t k) {
+  std::vector<Candidate> heap;
+  heap.reserve(k + 1);
+  for (int p = 0; p < int(cluster->regions.size()); p++) {
+    Region *r = cluster->regions[p];
+    if (score[r->id] == -INFINITY) {
       continue;
     }
-    places = filterObjects(mc->regions,
-                           (filterFunc<Region>)[&](Region * r) {
-                             bool cond = r->city == nullptr &&
-                                         r->minerals > 1 &&
-                                         r->biom != biom::LAKE &&
-                                         r->biom != biom::SNOW &&
-                                         r->biom != biom::ICE;
-                             // if (cond && std::none_of(cache.begin(),
-                             // cache.end(), [&](Region *ri){
-                             //       for (auto rn : cache) {
-                             //         if (mg::getDistance(ri->site, rn->site)
-                             //         < 20) {
-                             //           return true;
-                             //         }
-                             //       }
-                             //       return false;
-                             //     })) {
-                             //   cache.push_back(r);
-                             // } else {
-                             //   return false;
-                             // }
-                             return cond;
-                           },
-                           (sortFunc<Region>)[&](Region * r, Region * r2) {
-                             if (r->minerals > r2->minerals) {
-                               return true;
-                             }
-                             return false;
-                           });
-    for (auto r : places) {
-      bool canPlace = true;
-      for (auto n : r->neighbors) {
-        if (n->city != nullptr) {
-          canPlace = false;
-          break;
-        }
-      }
-      if (!canPlace) {
-        continue;
-      }
-      // TODO: decluster it.
-      City *c = new City(r, names::generateCityName(_gen), MINE);
-      map->cities.push_back(c);
-      mc->cities.push_back(c);
+    Candidate c = {score[r->id], p, r};
+    // The heap keeps the worst of the k best on top.
+    if (heap.size() < k) {
+      heap.push_back(c);
+      std::push_heap(heap.begin(), heap.end());
+    } else if (c < heap.front()) {
+      std::pop_heap(heap.begin(), heap.end());
+      heap.back() = c;
+      std::push_heap(heap.begin(), heap.end());
     }
   }
+  std::sort_heap(heap.begin(), heap.end());
+  return heap;
+}
+
+bool hasCityNearby(Region *r) {
+  return r->city != nullptr ||
+         std::any_of(r->neighbors.begin(), r->neighbors.end(),
+                     [](Region *n) { return n->city != nullptr; });
+}
 
+} // namespace
+
+void MapGenerator::makeCities() {
+  map->status = "Founding cities...";
+  auto cities = _gen.stream(mg::CITIES_STREAM);
+
+  // One pass scores every region for every city type; -infinity means
+  // the region does not qualify. Mines and farms only go to the mineral
+  // and niceness peaks of makeFinalRegions, the most prominent first.
+  const LocationType types[] = {MINE, AGRO, PORT};
+  int n = int(map->regions.size());
+  std::vector<float> scores[3];
+  for (auto &score : scores) {
+    score.assign(n, -INFINITY);
+  }
+  std::vector<float> rank[2] = {std::vector<float>(n, -INFINITY),
+                                std::vector<float>(n, -INFINITY)};
   for (auto mc : map->megaClusters) {
-    if (!mc->isLand) {
-      continue;
+    for (size_t k = 0; k < mc->resourcePoints.size(); k++) {
+      rank[0][mc->resourcePoints[k]->id] = -float(k);
     }
-    places = filterObjects(
-        mc->regions,
-        (filterFunc<Region>)[&](Region * r) {
-          return r->city == nullptr && r->nice > 0.7 &&
-                 r->biom.feritlity > 0.7 && r->biom != biom::LAKE;
-        },
-        (sortFunc<Region>)[&](Region * r, Region * r2) {
-          if (r->nice * r->biom.feritlity > r2->nice * r2->biom.feritlity) {
-            return true;
-          }
-          return false;
-        });
-    for (auto r : places) {
-      bool canPlace = true;
-      for (auto n : r->neighbors) {
-        if (n->city != nullptr) {
-          canPlace = false;
-          break;
-        }
-      }
-      if (!canPlace) {
-        continue;
-      }
-      City *c = new City(r, names::generateCityName(_gen), AGRO);
-      map->cities.push_back(c);
-      mc->cities.push_back(c);
+    for (size_t k = 0; k < mc->goodPoints.size(); k++) {
+      rank[1][mc->goodPoints[k]->id] = -float(k);
     }
   }
+  mg::parallelFor(n, [&](int i) {
+    Region *r = map->regions[i];
+    if (!r->megaCluster->isLand || r->city != nullptr) {
+      return;
+    }
+    if (r->minerals > 1 && r->biom != biom::LAKE && r->biom != biom::SNOW &&
+        r->biom != biom::ICE) {
+      scores[0][i] = rank[0][i];
+    }
+    if (r->nice > 0.7 && r->biom.feritlity > 0.7 && r->biom != biom::LAKE) {
+      scores[1][i] = rank[1][i];
+    }
+    bool deep = std::any_of(r->neighbors.begin(), r->neighbors.end(),
+                            [](Region *rn) {
+                              return rn->getHeight(rn->site) < 0.01;
+                            });
+    // Ports keep the cluster order, so all of them score the same.
+    if (deep && isSmallSea(r, 100, 200)) {
+      scores[2][i] = 0.f;
+    }
+  });
 
+  std::vector<Cluster *> lands;
   for (auto mc : map->megaClusters) {
-    if (!mc->isLand) {
-      continue;
+    if (mc->isLand) {
+      lands.push_back(mc);
     }
-
-    int b = 200;
-
-    std::vector<Region *> cache;
-    places = filterObjects(
-        mc->regions,
-        (filterFunc<Region>)[&](Region * r) {
-          if (r->megaCluster->cities.size() == 0) {
-            return false;
-          }
-
-          bool deep = false;
-          for (auto n : r->neighbors) {
-            if (n->getHeight(n->site) < 0.01) {
-              deep = true;
-              break;
-            }
-          }
-          if (!deep || r->city != nullptr) {
-            return false;
-          }
-          std::vector<Region *> seas;
-          getSea(&seas, r, r);
-          int sc = int(seas.size());
-
-          bool cond = (int)sc < b;
-
-          if (cond) {
-            for (auto cc : cache) {
-              if (mg::getDistance(r->site, cc->site) < 200) {
-                return false;
-              }
-            }
-
-            cache.push_back(r);
+  }
+  // Landmasses never touch each other, so every one places its cities on
+  // its own task and random stream. Conflicts are resolved in order: all
+  // mines, then farms, then ports, and no city is founded next to another
+  // one. Names come at the merge, which goes in landmass order.
+  std::vector<std::vector<City *>> founded(lands.size());
+  mg::parallelTasks(int(lands.size()), [&](int c) {
+    Cluster *mc = lands[c];
+    auto &placed = founded[c];
+    bool hasPort = false;
+    for (int t = 0; t < 3; t++) {
+      if (types[t] == PORT && placed.size() == 0) {
+        continue;
+      }
+      SpatialHash ports(200);
+      for (auto &candidate : topCandidates(mc, scores[t], _cityCandidates)) {
+        Region *r = candidate.region;
+        if (types[t] == PORT) {
+          if (r->city != nullptr || ports.anyWithin(r->site, 200)) {
+            continue;
           }
-
-          return cond;
-        },
-        (sortFunc<Region>)[&](Region * r, Region * r2) { return false; });
-
-    for (auto r : places) {
-      bool canPlace = true;
-      for (auto n : r->neighbors) {
-        if (n->city != nullptr) {
-          canPlace = false;
-          break;
+          ports.insert(r);
+        }
+        if (!hasCityNearby(r)) {
+          placed.push_back(new City(r, Name(), types[t]));
+          hasPort = hasPort || types[t] == PORT;
         }
       }
-      if (!canPlace) {
-        continue;
-      }
-
-      City *c = new City(r, names::generateCityName(_gen), PORT);
-      map->cities.push_back(c);
-      mc->cities.push_back(c);
-      mc->hasPort = true;
     }
-  }
-
-  for (auto mc : map->megaClusters) {
-    if (!mc->hasPort && mc->cities.size() > 0) {
-      places = filterObjects(
-          mc->regions,
-          (filterFunc<Region>)[&](Region * r) {
-
-            bool deep = false;
-            for (auto n : r->neighbors) {
-              if (!n->megaCluster->isLand) {
-                deep = true;
-                break;
-              }
-            }
-            if (!deep || r->city != nullptr) {
-              return false;
-            }
-            return true;
-          },
-          (sortFunc<Region>)[&](Region * r, Region * r2) { return false; });
 
-      if (places.size() == 0) {
-        continue;
+    if (hasPort || placed.size() == 0) {
+      return;
+    }
+    std::vector<Region *> places;
+    for (auto r : mc->regions) {
+      if (r->isCoast() && r->city == nullptr) {
+        places.push_back(r);
+      }
+    }
+    if (places.size() != 0) {
+      auto gen = cities.stream(PORT).stream(mc->regions.front()->id);
+      Region *r = *select_randomly(places.begin(), places.end(), gen);
+      placed.push_back(new City(r, Name(), PORT));
+    }
+  });
+
+  for (size_t c = 0; c < lands.size(); c++) {
+    for (auto city : founded[c]) {
+      auto gen = cities.stream(city->region->id);
+      city->name = map->namePool.take(names::generateCityName, gen);
+      map->cities.push_back(city);
+      lands[c]->cities.push_back(city);
+      if (city->type == PORT) {
+        lands[c]->hasPort = true;
       }
-
-      auto r = *select_randomly(places.begin(), places.end());
-
-      City *c = new City(r, names::generateCityName(_gen), PORT);
-      map->cities.push_back(c);
-      mc->cities.push_back(c);
-      mc->hasPort = true;
     }
   }
-  std::shuffle(map->cities.begin(), map->cities.end(), *_gen);
+  std::shuffle(map->cities.begin(), map->cities.end(), cities);
 }
 
 void MapGenerator::makeMinerals() {
@@ -570,30 +750,20 @@ void MapGenerator::makeMinerals() {
 }
 
 void MapGenerator::makeBorders() {
-  for (auto c : map->megaClusters) {
-    for (auto r : c->regions) {
-      if (!r->border) {
-        continue;
-      }
-
-      Cell *c = r->cell;
-      for (auto n : c->getNeighbors()) {
-        Region *rn = _cells[n];
-        if (rn->biom != r->biom) {
-          for (auto e : n->getEdges()) {
-            if (c->pointIntersection(e->startPoint()->x, e->startPoint()->y) ==
-                0) {
-              r->megaCluster->border.push_back(e->startPoint());
-            }
-          }
-        }
+  map->status = "Tracing coastlines...";
+  auto trace = [&](std::vector<Cluster *> &clusters, Cluster *Region::*of) {
+    mg::parallelTasks(int(clusters.size()), [&](int i) {
+      Cluster *c = clusters[i];
+      c->borders = mg::traceBorders(c->regions, map->regions,
+                                    [&](Region *r) { return r->*of == c; });
+      c->borderImportance.clear();
+      for (auto &loop : c->borders) {
+        c->borderImportance.push_back(mg::lineImportance(loop));
       }
-    }
-    // TODO: sort points by distance;
-    // TODO: do something with inner points
-    // std::sort(r->megaCluster->border.begin(), r->megaCluster->border.end(),
-    // borderOrdered);
-  }
+    });
+  };
+  trace(map->megaClusters, &Region::megaCluster);
+  trace(map->clusters, &Region::cluster);
 }
 
 void MapGenerator::setMapTemplate(const char *templateName) {
@@ -666,229 +836,230 @@ void MapGenerator::makeHeights() {
 
 void MapGenerator::makeRiver(Region *r) {
   map->status = "Making rivers...";
-  std::vector<Cell *> visited;
-  Cell *c = r->cell;
-  float z = r->getHeight(r->site);
   River *rvr = new River();
 
-  rvr->name = names::generateRiverName(_gen);
+  auto gen = _gen.stream(mg::RIVERS_STREAM).stream(r->id);
+  rvr->name = map->namePool.take(names::generateRiverName, gen);
   PointList *river = new PointList();
   rvr->points = river;
   map->rivers.push_back(rvr);
-  river->push_back(r->site);
-  visited.push_back(c);
-
-  Point next = r->site;
-  for (auto e : c->getEdges()) {
-    if (r->getHeight(e->startPoint()) < z) {
-      next = e->startPoint();
-      z = r->getHeight(next);
-    }
-  }
-
-  int count = 0;
-	Cell *end = nullptr;
-  while (count < 100) {
-    std::vector<Cell *> n = c->getNeighbors();
 
-    for (Cell *c2 : n) {
-      if (std::find(visited.begin(), visited.end(), c2) != visited.end()) {
-        continue;
-      }
-      visited.push_back(c2);
-      r = _cells[c2];
-      r->megaCluster->hasRiver = true;
-      bool f = false;
-      for (auto e : c2->getEdges()) {
-        if (r->getHeight(e->startPoint()) < z) {
-          next = e->startPoint();
-          z = r->getHeight(next);
-          c = c2;
-          f = true;
-        }
-      }
-      if (f) {
-        river->push_back(r->site);
-        rvr->regions.push_back(r);
-        r->hasRiver = true;
-        r->biom.feritlity += 0.2;
-      }
-      end = c2;
+  while (true) {
+    river->push_back(r->site);
+    if (!r->megaCluster->isLand) {
+      // The sea collects every river, keep the width of the mouth.
+      rvr->discharge.push_back(rvr->discharge.back());
+      break;
     }
-    count++;
+    rvr->discharge.push_back(r->discharge);
+    r->megaCluster->hasRiver = true;
+    rvr->regions.push_back(r);
 
-    if (count == 100) {
+    if (hydrology->isDepression(r->id)) {
       r->biom = biom::LAKE;
-      river->push_back(r->site);
-      rvr->regions.push_back(r);
       r->humidity = 1;
-
-		  for (auto n : end->getNeighbors()) {
-			r = _cells[n];
-			r->biom = biom::LAKE;
-			r->humidity = 1;
-		  }
+      for (auto n : r->neighbors) {
+        if (n->megaCluster->isLand && hydrology->isDepression(n->id)) {
+          n->biom = biom::LAKE;
+          n->humidity = 1;
+        }
+      }
+      break;
+    }
+    // Joined an earlier river, the rest of the way is already drawn.
+    if (r->hasRiver) {
       break;
     }
-    if (r->getHeight(r->site) < 0.0625) {
-      river->push_back(r->site);
+    r->hasRiver = true;
+    r->fertilityBonus += std::min(0.3f, 0.2f * std::sqrt(r->discharge));
+    int next = hydrology->downstream[r->id];
+    if (next == -1) {
       break;
     }
+    r = map->regions[next];
   }
 }
 
 void MapGenerator::makeRivers() {
-  // TODO: make more rivers
   map->status = "Making rivers...";
   map->rivers.clear();
 
-  std::vector<Region *> localMaximums;
+  auto heights = mg::gather<float>(
+      map->regions, [](Region *r) { return r->getHeight(r->site); });
+  auto isSea = mg::gather<char>(
+      map->regions, [](Region *r) { return char(!r->megaCluster->isLand); });
+  hydrology->drain(map->graph, heights, isSea);
+  auto runoff = mg::gather<float>(
+      map->regions, [](Region *r) { return r->megaCluster->isLand ? 1.f : 0.f; });
+  hydrology->accumulate(runoff);
+
+  float threshold = hydrology->riverThreshold();
+  for (auto r : map->regions) {
+    r->discharge = hydrology->discharge[r->id] / threshold;
+  }
+
+  // A river starts where no other river flows in. A lake ends the river
+  // that fills it, so its outflow starts a new one.
+  std::vector<char> fed(map->regions.size(), 0);
+  for (auto r : map->regions) {
+    int next = hydrology->downstream[r->id];
+    if (next != -1 && hydrology->isRiver(r->id) &&
+        !hydrology->isDepression(r->id)) {
+      fed[next] = 1;
+    }
+  }
+
   for (auto cluster : map->megaClusters) {
     if (!cluster->isLand || cluster->regions.size() < 50) {
       continue;
     }
     for (auto r : cluster->regions) {
-      Cell *c = r->cell;
-      if (c == nullptr) {
-        continue;
-      }
-      auto ns = c->getNeighbors();
-      if (std::count_if(ns.begin(), ns.end(),
-                        [&](Cell *oc) {
-                          Region *reg = _cells[oc];
-                          return reg->getHeight(reg->site) >
-                                 r->getHeight(r->site);
-                        }) == 0 &&
-          r->getHeight(r->site) > 0.66) {
-        localMaximums.push_back(r);
+      if (hydrology->isRiver(r->id) && !fed[r->id] &&
+          !hydrology->isDepression(r->id)) {
+        makeRiver(r);
       }
     }
   }
 
-  for (auto lm : localMaximums) {
-    makeRiver(lm);
+  for (auto r : map->regions) {
+    for (auto n : r->neighbors) {
+      if (n->biom == biom::LAKE) {
+        r->fertilityBonus += 0.2f;
+      }
+    }
   }
 }
 
+// Biome (an index into biom::classifier().bioms) and niceness of every
+// region for its current height, humidity and temperature.
+void MapGenerator::classifyRegions(std::vector<int> &bioms,
+                                   std::vector<float> &nice) {
+  auto &table = biom::classifier();
+  float hotBorder = weather->meanTemperature * 4 / 5;
+  float mildTemperature = weather->meanTemperature * 2.f / 3.f;
+
+  int n = int(map->regions.size());
+  bioms.resize(n);
+  nice.resize(n);
+  mg::parallelFor(n, [&](int i) {
+    Region *r = map->regions[i];
+    float height = r->getHeight(r->site);
+    float humidity = r->humidity;
+    float temperature = r->temperature;
+    bool isHot = (temperature > hotBorder) & (humidity < 0.2f);
+    bioms[i] = table.classify(height, humidity, isHot);
+    float hc = std::max(0.f, 1.f - std::abs(humidity - 0.8f));
+    float hic = std::max(0.f, 1.f - std::abs(height - 0.7f));
+    float tc = std::max(0.f, 1.f - std::abs(temperature - mildTemperature));
+    nice[i] = (hc + hic + tc) / 3.f;
+  });
+}
+
 void MapGenerator::makeFinalRegions() {
   map->status = "Making forrests and deserts...";
+  std::vector<int> bioms;
+  std::vector<float> nice;
+  classifyRegions(bioms, nice);
+  _bioms = bioms;
+  auto &table = biom::classifier();
   for (auto r : map->regions) {
     if (r->biom == biom::LAKE) {
       r->minerals = 0;
+      nice[r->id] = r->nice;
       continue;
     }
     r->minerals = _mineralsMap.GetValue(r->site->x, r->site->y);
     r->minerals = r->minerals > 0 ? r->minerals : 0;
-    float ht = r->getHeight(r->site);
-    Biom b = biom::BIOMS[0];
-    for (int i = 0; i < int(biom::BIOMS.size()); i++) {
-      if (ht > biom::BIOMS[i].border) {
-        int n = (biom::BIOMS_BY_HEIGHT[i].size() - 1) -
-                r->humidity * (biom::BIOMS_BY_HEIGHT[i].size() - 1);
-        if (n < 0) continue;
-          // std::cout<< i << "||" << n << std::endl;
-        b = biom::BIOMS_BY_HEIGHT[i][n];
-        if (biom::BIOMS_BY_TEMP.count(b.name) != 0) {
-          if (r->temperature > weather->temperature * 4 / 5 && r->humidity < 0.2) {
-            b = biom::BIOMS_BY_TEMP.at(b.name);
-          }
-        }
-        if (b.name == "") {
-          std::cout<< i << "||" << n << std::endl;
-        }
-      }
-    }
-    r->biom = b;
-    float hc = (1.f - std::abs(r->humidity - 0.8f));
-    hc = hc <= 0 ? 0 : hc / 3.f;
-    float hic = (1.f - std::abs(r->getHeight(r->site) - 0.7f));
-    hic = hic <= 0 ? 0 : hic / 3.f;
-    float tc = (1.f - std::abs(r->temperature - weather->temperature * 2.f / 3.f));
-    tc = tc <= 0 ? 0 : tc / 3.f;
-
-    r->nice = hc + hic + tc;
-        // if (r->biom.name == "") {
-        //   std::cout<< r->humidity << "||" << r->nice << std::endl;
-        //   // std::cout<< i << "||" << n << std::endl;
-        // }
+    r->biom = table.bioms[bioms[r->id]];
+    r->biom.feritlity += r->fertilityBonus;
+    r->nice = nice[r->id];
   }
 
-  for (auto cluster : map->megaClusters) {
-    if (!cluster->isLand) {
-      continue;
+  auto minerals = mg::gather<float>(map->regions,
+                                    [](Region *r) { return r->minerals; });
+  // Deposits and the nicest places are the peaks of their fields, the
+  // most prominent ones first.
+  auto isResource = mg::localMaxima(map->graph, minerals);
+  auto isGood = mg::localMaxima(map->graph, nice);
+  mg::parallelFor(int(map->regions.size()), [&](int i) {
+    Region *r = map->regions[i];
+    if (!r->megaCluster->isLand || minerals[i] == 0) {
+      isResource[i] = 0;
     }
-    for (auto r : cluster->regions) {
-      Cell *c = r->cell;
-      if (c == nullptr) {
-        continue;
-      }
-      auto ns = c->getNeighbors();
-      if (std::count_if(ns.begin(), ns.end(),
-                        [&](Cell *oc) {
-                          Region *reg = _cells[oc];
-                          return reg->minerals > r->minerals;
-                        }) == 0 &&
-          r->minerals != 0) {
-        cluster->resourcePoints.push_back(r);
-      }
-
-      if (std::count_if(ns.begin(), ns.end(),
-                        [&](Cell *oc) {
-                          Region *reg = _cells[oc];
-                          return reg->nice >= r->nice;
-                        }) == 0 &&
-          r->biom != biom::LAKE) {
-        cluster->goodPoints.push_back(r);
-      }
+    if (!r->megaCluster->isLand || r->biom == biom::LAKE) {
+      isGood[i] = 0;
     }
+  });
+  for (int i : mg::rankExtrema(isResource,
+                               mg::prominence(map->graph, minerals))) {
+    map->regions[i]->megaCluster->resourcePoints.push_back(map->regions[i]);
+  }
+  for (int i : mg::rankExtrema(isGood, mg::prominence(map->graph, nice))) {
+    map->regions[i]->megaCluster->goodPoints.push_back(map->regions[i]);
   }
 }
 
 void MapGenerator::makeRegions() {
   map->status = "Spliting land and sea...";
-  _cells.clear();
   map->regions.clear();
   map->regions.reserve(_diagram->cells.size());
-  Biom lastBiom = biom::BIOMS[0];
-  for (auto c : _diagram->cells) {
-    if (c == nullptr) {
-      continue;
-    }
 
-    PointList verts;
-    int count = int(c->getEdges().size());
-    verts.reserve(count);
+  // Neighbouring cells share corners, so every vertex is sampled once.
+  auto &vertices = map->vertices;
+  vertices.build(_diagram->cells);
+  mg::parallelFor(int(vertices.points.size()), [&](int i) {
+    Point p = vertices.points[i];
+    vertices.heights[i] = _heightMap.GetValue(p->x, p->y);
+  });
+
+  for (int i = 0; i < int(_diagram->cells.size()); i++) {
+    Cell *c = _diagram->cells[i];
 
     float ht = 0;
-    std::map<sf::Vector2<double> *, float> h;
-    for (int i = 0; i < count; i++) {
-      sf::Vector2<double> *p0;
-      p0 = c->getEdges()[i]->startPoint();
-      verts.push_back(p0);
-
-      h.insert(std::make_pair(p0, _heightMap.GetValue(p0->x, p0->y)));
-      ht += h[p0];
+    int start = vertices.cellStart[i];
+    int count = vertices.cellStart[i + 1] - start;
+    for (int k = 0; k < count; k++) {
+      ht += vertices.heights[vertices.cellVertices[start + k]];
     }
     ht = ht / count;
-    sf::Vector2<double> &p = c->site.p;
-    h.insert(std::make_pair(&p, ht));
+    Point2 &p = c->site.p;
     Biom b = ht < 0.0625 ? biom::SEA : biom::LAND;
-    Region *region = new Region(b, verts, h, &p);
+    Region *region = new Region(b, &vertices, i, &p, ht);
     region->city = nullptr;
     region->cell = c;
+    region->id = i;
     region->humidity = biom::DEFAULT_HUMIDITY;
-    region->border = false;
-    region->hasRiver = false;
     map->regions.push_back(region);
-    _cells.insert(std::make_pair(c, region));
   }
 
   for (auto r : map->regions) {
     auto c = r->cell;
     for (auto n : c->getNeighbors()) {
-      r->neighbors.push_back(_cells[n]);
+      r->neighbors.push_back(map->regions[n->index]);
     }
   }
+  map->graph.build(map->regions);
+}
+
+void MapGenerator::makeErosion() {
+  if (_erosionIterations <= 0) {
+    return;
+  }
+  map->status = "Wearing mountains down...";
+  auto before = mg::gather<float>(
+      map->regions, [](Region *r) { return r->getHeight(r->site); });
+  auto isSea = mg::gather<char>(
+      map->regions, [](Region *r) { return char(r->biom == biom::SEA); });
+  // Land never erodes below the sea level used in makeRegions.
+  auto heights = before;
+  hydrology->erode(map->graph, heights, isSea, 0.0625, _erosionIterations);
+
+  std::vector<float> delta(heights.size());
+  for (auto r : map->regions) {
+    delta[r->id] = heights[r->id] - before[r->id];
+    r->setHeight(heights[r->id]);
+  }
+  map->vertices.shiftHeights(map->regions, delta);
 }
 
 bool isDiscard(const Cluster *c) { return c->regions.size() == 0; }
@@ -901,27 +1072,25 @@ std::vector<Cluster *> MapGenerator::clusterize(std::vector<Region *> regions,
                                                 createFunc createCluster) {
   std::vector<Cluster *> clusters;
 
-  std::map<Region *, Cluster *> _clusters;
+  std::vector<Cluster *> _clusters(map->regions.size(), nullptr);
   for (auto r : regions) {
-    Cell *c = r->cell;
     bool cu = true;
     Cluster *knownCluster = nullptr;
-    for (auto n : c->getNeighbors()) {
-      Region *rn = _cells[n];
+    for (auto rn : r->neighbors) {
       if (isNotSame(r, rn)) {
         r->border = true;
-      } else if (_clusters.count(rn) != 0) {
+      } else if (_clusters[rn->id] != nullptr) {
         cu = false;
         if (knownCluster == nullptr) {
-          knownCluster = _clusters[rn];
+          knownCluster = _clusters[rn->id];
           knownCluster->regions.push_back(r);
           assignCluster(r, knownCluster);
         } else {
-          _clusters[rn] = knownCluster;
+          _clusters[rn->id] = knownCluster;
           reassignCluster(rn, knownCluster, &_clusters);
           assignCluster(r, knownCluster);
         }
-        _clusters[r] = knownCluster;
+        _clusters[r->id] = knownCluster;
       }
     }
 
@@ -929,7 +1098,7 @@ std::vector<Cluster *> MapGenerator::clusterize(std::vector<Region *> regions,
       auto cluster = createCluster(r);
       assignCluster(r, cluster);
 
-      _clusters[r] = cluster;
+      _clusters[r->id] = cluster;
       clusters.push_back(cluster);
     }
   }
@@ -952,7 +1121,7 @@ void MapGenerator::makeMegaClusters() {
         r->cluster = knownCluster;
       },
       [&](Region *rn, Cluster *knownCluster,
-          std::map<Region *, Cluster *> *_clusters) {
+          std::vector<Cluster *> *_clusters) {
         Cluster *oldCluster = rn->megaCluster;
         if (oldCluster != knownCluster) {
           rn->cluster = knownCluster;
@@ -963,19 +1132,22 @@ void MapGenerator::makeMegaClusters() {
             if (std::find(kcrn.begin(), kcrn.end(), orn) == kcrn.end()) {
               knownCluster->regions.push_back(orn);
             }
-            (*_clusters)[orn] = knownCluster;
+            (*_clusters)[orn->id] = knownCluster;
           }
           oldCluster->regions.clear();
         }
       },
       [&](Region *r) {
         Cluster *cluster = new MegaCluster();
+        auto gen = _gen.stream(mg::CLUSTERS_STREAM).stream(r->id);
         cluster->isLand = r->biom == biom::LAND;
         cluster->megaCluster = cluster;
         if (cluster->isLand) {
-          cluster->name = names::generateLandName(_gen);
+          cluster->name =
+              map->namePool.take(names::generateLandName, gen);
         } else {
-          cluster->name = names::generateSeaName(_gen);
+          cluster->name =
+              map->namePool.take(names::generateSeaName, gen);
         }
         return cluster;
       }
@@ -989,22 +1161,20 @@ void MapGenerator::makeMegaClusters() {
 void MapGenerator::makeClusters() {
   map->status = "Meeting with neighbors...";
   map->clusters.clear();
-  cellsMap.clear();
-  std::map<Cell *, Cluster *> _clusters;
-  for (auto c : _diagram->cells) {
-    Region *r = _cells[c];
+  std::vector<Cluster *> _clusters(map->regions.size(), nullptr);
+  for (auto r : map->regions) {
     bool cu = true;
     Cluster *knownCluster = nullptr;
-    for (auto n : c->getNeighbors()) {
-      Region *rn = _cells[n];
+    for (auto rn : r->neighbors) {
+      int n = rn->id;
       if (r->biom != rn->biom) {
         r->border = true;
-      } else if (_clusters.count(n) != 0) {
+      } else if (_clusters[n] != nullptr) {
         cu = false;
         if (knownCluster == nullptr) {
           r->cluster = _clusters[n];
           _clusters[n]->regions.push_back(r);
-          _clusters[c] = _clusters[n];
+          _clusters[r->id] = _clusters[n];
           knownCluster = _clusters[n];
         } else {
           Cluster *oldCluster = rn->cluster;
@@ -1017,31 +1187,25 @@ void MapGenerator::makeClusters() {
               if (std::find(kcrn.begin(), kcrn.end(), orn) == kcrn.end()) {
                 knownCluster->regions.push_back(orn);
               }
-              _clusters[cellsMap[orn]] = knownCluster;
+              _clusters[orn->id] = knownCluster;
             }
             oldCluster->regions.clear();
           }
 
           r->cluster = knownCluster;
-          _clusters[c] = knownCluster;
-          cellsMap[r] = c;
+          _clusters[r->id] = knownCluster;
         }
         continue;
       }
     }
     if (cu) {
       Cluster *cluster = new Cluster();
-      char buff[100];
-      snprintf(buff, sizeof(buff), "%p", (void *)cluster);
-      std::string buffAsStdStr = buff;
-      cluster->name = buffAsStdStr;
       cluster->hasRiver = false;
       r->cluster = cluster;
       cluster->biom = r->biom;
       cluster->isLand = r->biom.border > 0;
       cluster->regions.push_back(r);
-      _clusters[c] = cluster;
-      cellsMap[r] = c;
+      _clusters[r->id] = cluster;
       map->clusters.push_back(cluster);
     }
   }
@@ -1054,7 +1218,37 @@ void MapGenerator::makeClusters() {
   }
 }
 
+void MapGenerator::makeHierarchy() {
+  map->status = "Zooming out...";
+  // Same scale as the river tolerance, in mean region areas.
+  float tolerance = _riverTolerance * float(_w) * float(_h) / _pointsCount;
+  map->hierarchy.build(map->regions, map->graph, _levelCount, tolerance);
+  for (auto &level : map->hierarchy.levels) {
+    mg::info("Level regions:", level.size());
+  }
+}
+
+const RegionLevel *MapGenerator::getLevel(int level) {
+  if (level < 0 || level >= getBuiltLevelCount()) {
+    return nullptr;
+  }
+  return &map->hierarchy.levels[level];
+}
+
+int MapGenerator::getSuperRegion(int level, sf::Vector2f pos) {
+  if (level < 0 || level >= getBuiltLevelCount()) {
+    return -1;
+  }
+  Region *r = getRegion(nullptr, pos);
+  return r == nullptr ? -1 : map->hierarchy.levels[level].of[r->id];
+}
+
 Region *MapGenerator::getRegion(Region* startRegion, sf::Vector2f pos) {
+  Region *r = map->hierarchy.find(map->regions, map->graph,
+                                  Point2(pos.x, pos.y));
+  if (r != nullptr && r->cell->pointIntersection(pos.x, pos.y) != -1) {
+    return r;
+  }
   for (auto region : map->regions) {
       if (region->cell->pointIntersection(pos.x, pos.y) != -1) {
         return region;
@@ -1077,8 +1271,9 @@ bool damagedCell(Cell *c) {
 void MapGenerator::makeDiagram() {
   map->status = "Making nothing...";
   _bbox = sf::Rect<double>(0, 0, _w, _h);
-  _sites = new std::vector<sf::Vector2<double>>();
-  genRandomSites(*_sites, _bbox, _w, _h, _pointsCount);
+  _sites = new std::vector<Point2>();
+  genRandomSites(*_sites, _bbox, _w, _h, _pointsCount,
+                 _gen.stream(mg::SITES_STREAM));
   _diagram.reset(_vdg.compute(*_sites, _bbox));
   for (int n = 0; n < _relax; n++) {
     map->status = "Relaxing...";
@@ -1093,29 +1288,33 @@ void MapGenerator::makeDiagram() {
   delete _sites;
 
   std::sort(_diagram->cells.begin(), _diagram->cells.end(), cellsOrdered);
+  for (int i = 0; i < int(_diagram->cells.size()); i++) {
+    _diagram->cells[i]->index = i;
+  }
+  map->diagram = _diagram.get();
 }
 
-void MapGenerator::genRandomSites(std::vector<sf::Vector2<double>> &sites,
+void MapGenerator::genRandomSites(std::vector<Point2> &sites,
                                   sf::Rect<double> &bbox, unsigned int dx,
-                                  unsigned int dy, unsigned int numSites) {
-  std::vector<sf::Vector2<double>> tmpSites;
+                                  unsigned int dy, unsigned int numSites,
+                                  mg::Random gen) {
+  std::vector<Point2> tmpSites;
 
   tmpSites.reserve(numSites);
   sites.reserve(numSites);
 
-  sf::Vector2<double> s;
+  Point2 s;
 
-  srand(_seed);
   for (unsigned int i = 0; i < numSites; ++i) {
-    s.x = 1 + (rand() / (double)RAND_MAX) * (dx - 2);
-    s.y = 1 + (rand() / (double)RAND_MAX) * (dy - 2);
+    s.x = 1 + gen.uniform() * (dx - 2);
+    s.y = 1 + gen.uniform() * (dy - 2);
     tmpSites.push_back(s);
   }
 
   // remove any duplicates that exist
   std::sort(tmpSites.begin(), tmpSites.end(), sitesOrdered);
   sites.push_back(tmpSites[0]);
-  for (sf::Vector2<double> &s : tmpSites) {
+  for (Point2 &s : tmpSites) {
     if (s != sites.back())
       sites.push_back(s);
   }
@@ -0,0 +1,68 @@
+#include "mapgen/Polyline.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+typedef std::pair<float, int> AreaNode;
+
+std::vector<float> mg::lineImportance(const PointList &line) {
+  int n = int(line.size());
+  std::vector<float> importance(n, std::numeric_limits<float>::infinity());
+  if (n < 3) {
+    return importance;
+  }
+
+  std::vector<int> prev(n);
+  std::vector<int> next(n);
+  std::vector<float> area(n);
+  auto triangle = [&](int i) {
+    Point a = line[prev[i]];
+    Point b = line[i];
+    Point c = line[next[i]];
+    return float(std::abs(double(b->x - a->x) * double(c->y - a->y) -
+                          double(c->x - a->x) * double(b->y - a->y)) /
+                 2);
+  };
+
+  std::priority_queue<AreaNode, std::vector<AreaNode>, std::greater<AreaNode>>
+      open;
+  for (int i = 0; i < n; i++) {
+    prev[i] = i - 1;
+    next[i] = i + 1;
+  }
+  for (int i = 1; i < n - 1; i++) {
+    area[i] = triangle(i);
+    open.push(std::make_pair(area[i], i));
+  }
+
+  // Areas are made monotonic, so a point never outlives one that was
+  // removed before it.
+  float last = 0.f;
+  while (!open.empty()) {
+    AreaNode top = open.top();
+    open.pop();
+    int i = top.second;
+    if (importance[i] != std::numeric_limits<float>::infinity() ||
+        top.first != area[i]) {
+      continue;
+    }
+    last = std::max(last, top.first);
+    importance[i] = last;
+
+    int p = prev[i];
+    int q = next[i];
+    next[p] = q;
+    prev[q] = p;
+    if (p > 0) {
+      area[p] = triangle(p);
+      open.push(std::make_pair(area[p], p));
+    }
+    if (q < n - 1) {
+      area[q] = triangle(q);
+      open.push(std::make_pair(area[q], q));
+    }
+  }
+  return importance;
+}
@@ -2,25 +2,53 @@
 #include <vector>
 #include <cmath>
 
-Region::Region() {};
+Region::Region()
+  : hasRiver(false), border(false), hasRoad(false), stateBorder(false),
+    seaBorder(false), coast(false) {};
 
-Region::Region(Biom b, PointList v, HeightMap h, Point s)
-  : biom(b), _verticies(v), _heights(h), site(s) {}
+Region::Region(Biom b, VertexTable *t, int cellIndex, Point s, float sh)
+  : biom(b), site(s), hasRiver(false), border(false), hasRoad(false),
+    stateBorder(false), seaBorder(false), coast(false), _siteHeight(sh),
+    _firstVertex(t->cellStart[cellIndex]),
+    _vertexCount(t->cellStart[cellIndex + 1] - t->cellStart[cellIndex]),
+    _table(t) {}
 
 PointList Region::getPoints() {
-  return _verticies;
+  PointList points;
+  points.reserve(_vertexCount);
+  for (int i = 0; i < _vertexCount; i++) {
+    points.push_back(_table->points[getVertexId(i)]);
+  }
+  return points;
 };
 
+int Region::getVertexCount() { return _vertexCount; }
+
+int Region::getVertexId(int i) {
+  return _table->cellVertices[_firstVertex + i];
+}
+
 float Region::getHeight(Point p) {
-  return _heights[p];
+  if (p == site) {
+    return _siteHeight;
+  }
+  for (int i = 0; i < _vertexCount; i++) {
+    int v = getVertexId(i);
+    if (_table->points[v] == p) {
+      return _table->heights[v];
+    }
+  }
+  return 0.f;
 }
 
-bool Region::isCoast() {
-  return std::count_if(neighbors.begin(), neighbors.end(), [&](Region* n) {
-      return !n->megaCluster->isLand;
-    }) != 0;
+void Region::setHeight(float h) { _siteHeight = h; }
+
+size_t Region::memoryUsage() {
+  return sizeof(Region) + neighbors.capacity() * sizeof(Region *);
 }
 
+bool Region::isCoast() { return coast; }
+
 bool Region::isLakeCoast() {
   return std::count_if(neighbors.begin(), neighbors.end(), [&](Region* n) {
       return n->biom == biom::LAKE;
@@ -37,15 +65,19 @@ Region* Region::getRegionWithDirection(float angle, float force) {
       continue;
     }
 
-    //TODO: fix angle > 180
     auto dx = n->site->x - site->x;
     auto dy = n->site->y - site->y;
     ar = atan2(dy, dx);
     ar *= 180.f / M_PI;
-    if (nr == nullptr || abs(ar - angle) < cabs) {
+    // Angles wrap, 350 and -10 degrees point the same way.
+    float d = std::fmod(std::abs(ar - angle), 360.f);
+    if (d > 180.f) {
+      d = 360.f - d;
+    }
+    if (nr == nullptr || d < cabs) {
       nr = n;
       mar = ar;
-      cabs = abs(ar - angle);
+      cabs = d;
     }
   }
   // std::cout << cabs << std::endl;
@@ -0,0 +1,83 @@
+#include "mapgen/RegionGraph.hpp"
+#include <algorithm>
+
+void RegionGraph::build(std::vector<Region *> &regions) {
+  offsets.clear();
+  ids.clear();
+  offsets.reserve(regions.size() + 1);
+  ids.reserve(regions.size() * 6);
+  for (auto r : regions) {
+    offsets.push_back(int(ids.size()));
+    for (auto n : r->neighbors) {
+      ids.push_back(n->id);
+    }
+  }
+  offsets.push_back(int(ids.size()));
+}
+
+size_t RegionGraph::memoryUsage() {
+  return (offsets.capacity() + ids.capacity()) * sizeof(int);
+}
+
+int RegionGraph::aggregate(const std::vector<int> &group,
+                           std::vector<int> &parent) const {
+  int n = size();
+  int count = 0;
+  parent.assign(n, -1);
+  // Nodes with no aggregated neighbour of their group take all of them.
+  for (int i = 0; i < n; i++) {
+    auto ns = neighbors(i);
+    if (parent[i] != -1 || std::any_of(ns.begin(), ns.end(), [&](int j) {
+          return group[j] == group[i] && parent[j] != -1;
+        })) {
+      continue;
+    }
+    parent[i] = count;
+    for (int j : ns) {
+      if (group[j] == group[i]) {
+        parent[j] = count;
+      }
+    }
+    count++;
+  }
+  // The rest join a neighbouring aggregate, or stay on their own.
+  std::vector<int> first(parent);
+  for (int i = 0; i < n; i++) {
+    if (parent[i] != -1) {
+      continue;
+    }
+    for (int j : neighbors(i)) {
+      if (group[j] == group[i] && first[j] != -1) {
+        parent[i] = first[j];
+        break;
+      }
+    }
+    if (parent[i] == -1) {
+      parent[i] = count++;
+    }
+  }
+  return count;
+}
+
+RegionGraph RegionGraph::coarsen(const std::vector<int> &parent,
+                                 int count) const {
+  std::vector<std::vector<int>> links(count);
+  for (int i = 0; i < size(); i++) {
+    for (int j : neighbors(i)) {
+      if (parent[i] != parent[j]) {
+        links[parent[i]].push_back(parent[j]);
+      }
+    }
+  }
+
+  RegionGraph coarse;
+  coarse.offsets.reserve(count + 1);
+  for (auto &l : links) {
+    std::sort(l.begin(), l.end());
+    l.erase(std::unique(l.begin(), l.end()), l.end());
+    coarse.offsets.push_back(int(coarse.ids.size()));
+    coarse.ids.insert(coarse.ids.end(), l.begin(), l.end());
+  }
+  coarse.offsets.push_back(int(coarse.ids.size()));
+  return coarse;
+}
@@ -0,0 +1,195 @@
+#include "mapgen/RegionHierarchy.hpp"
+#include "mapgen/Polyline.hpp"
+#include "mapgen/utils.hpp"
+#include <unordered_map>
+
+static float squaredDistance(const Point2 &a, const Point2 &b) {
+  return float((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+}
+
+// Greedy walk to the node whose site is closest to p. On the full
+// Voronoi neighbourhood it always ends at the closest site, on coarse
+// levels it only gets near.
+template <typename S>
+static int walk(const RegionGraph &graph, int start, const Point2 &p,
+                S site) {
+  int current = start;
+  float best = squaredDistance(site(current), p);
+  for (bool moved = true; moved;) {
+    moved = false;
+    for (int n : graph.neighbors(current)) {
+      float d = squaredDistance(site(n), p);
+      if (d < best) {
+        best = d;
+        current = n;
+        moved = true;
+      }
+    }
+  }
+  return current;
+}
+
+void RegionHierarchy::build(std::vector<Region *> &regions,
+                            const RegionGraph &graph, int count,
+                            float tolerance) {
+  levels.clear();
+  levels.reserve(count);
+  std::unordered_map<Cluster *, int> clusters;
+  std::vector<int> group(regions.size());
+  for (auto r : regions) {
+    group[r->id] = clusters.emplace(r->cluster, int(clusters.size()))
+                       .first->second;
+  }
+
+  const RegionGraph *fine = &graph;
+  std::vector<int> of(regions.size());
+  for (size_t i = 0; i < of.size(); i++) {
+    of[i] = int(i);
+  }
+  for (int l = 0; l < count; l++) {
+    RegionLevel level;
+    int size = fine->aggregate(group, level.parent);
+    // Past a few levels clusters are down to one node each.
+    if (size > fine->size() * 3 / 4) {
+      break;
+    }
+    level.graph = fine->coarsen(level.parent, size);
+    level.of.resize(regions.size());
+    for (size_t i = 0; i < of.size(); i++) {
+      level.of[i] = level.parent[of[i]];
+    }
+
+    // Members sorted by super-region with a counting pass.
+    level.memberStart.assign(size + 1, 0);
+    for (int s : level.of) {
+      level.memberStart[s + 1]++;
+    }
+    for (int s = 0; s < size; s++) {
+      level.memberStart[s + 1] += level.memberStart[s];
+    }
+    level.members.resize(regions.size());
+    std::vector<int> next(level.memberStart.begin(),
+                          level.memberStart.end() - 1);
+    for (size_t i = 0; i < regions.size(); i++) {
+      level.members[next[level.of[i]]++] = int(i);
+    }
+
+    std::vector<int> coarseGroup(size);
+    for (int i = 0; i < fine->size(); i++) {
+      coarseGroup[level.parent[i]] = group[i];
+    }
+    group.swap(coarseGroup);
+    of = level.of;
+    levels.push_back(std::move(level));
+    fine = &levels.back().graph;
+  }
+
+  aggregate(regions);
+
+  for (auto &level : levels) {
+    float scale = tolerance * float(regions.size()) / float(level.size());
+    level.outline.resize(level.size());
+    mg::parallelFor(level.size(), [&](int s) {
+      std::vector<Region *> members;
+      for (int k = level.memberStart[s]; k < level.memberStart[s + 1]; k++) {
+        members.push_back(regions[level.members[k]]);
+      }
+      auto &loops = level.outline[s];
+      loops = mg::traceBorders(members, regions, [&](Region *r) {
+        return level.of[r->id] == s;
+      });
+      for (auto &loop : loops) {
+        auto importance = mg::lineImportance(loop);
+        mg::keepImportant(loop, importance, scale);
+      }
+    });
+  }
+}
+
+void RegionHierarchy::aggregate(std::vector<Region *> &regions) {
+  for (auto &level : levels) {
+    int size = level.size();
+    level.cluster.resize(size);
+    level.site.resize(size);
+    level.center.resize(size);
+    level.height.resize(size);
+    level.humidity.resize(size);
+    level.temperature.resize(size);
+    level.minerals.resize(size);
+    level.nice.resize(size);
+    mg::parallelFor(size, [&](int s) {
+      int first = level.memberStart[s];
+      int last = level.memberStart[s + 1];
+      float n = float(last - first);
+      Point2 site(0, 0);
+      float height = 0, humidity = 0, temperature = 0, minerals = 0, nice = 0;
+      for (int k = first; k < last; k++) {
+        Region *r = regions[level.members[k]];
+        site.x += r->site->x / n;
+        site.y += r->site->y / n;
+        height += r->getHeight(r->site);
+        humidity += r->humidity;
+        temperature += r->temperature;
+        minerals += r->minerals;
+        nice += r->nice;
+      }
+      int center = level.members[first];
+      for (int k = first; k < last; k++) {
+        int m = level.members[k];
+        if (squaredDistance(*regions[m]->site, site) <
+            squaredDistance(*regions[center]->site, site)) {
+          center = m;
+        }
+      }
+      level.cluster[s] = regions[center]->cluster;
+      level.site[s] = site;
+      level.center[s] = center;
+      level.height[s] = height / n;
+      level.humidity[s] = humidity / n;
+      level.temperature[s] = temperature / n;
+      level.minerals[s] = minerals / n;
+      level.nice[s] = nice / n;
+    });
+  }
+}
+
+Region *RegionHierarchy::find(std::vector<Region *> &regions,
+                              const RegionGraph &graph, Point2 p) const {
+  if (regions.size() == 0) {
+    return nullptr;
+  }
+  int start = 0;
+  for (int l = int(levels.size()) - 1; l >= 0; l--) {
+    auto &level = levels[l];
+    int s = walk(level.graph, level.of[start], p,
+                 [&](int i) { return level.site[i]; });
+    start = level.center[s];
+  }
+  int r = walk(graph, start, p, [&](int i) { return *regions[i]->site; });
+  return regions[r];
+}
+
+size_t RegionHierarchy::memoryUsage() {
+  size_t size = levels.capacity() * sizeof(RegionLevel);
+  for (auto &level : levels) {
+    size += level.graph.memoryUsage() +
+            (level.parent.capacity() + level.of.capacity() +
+             level.memberStart.capacity() + level.members.capacity() +
+             level.center.capacity()) *
+                sizeof(int) +
+            level.cluster.capacity() * sizeof(Cluster *) +
+            level.site.capacity() * sizeof(Point2) +
+            (level.height.capacity() + level.humidity.capacity() +
+             level.temperature.capacity() + level.minerals.capacity() +
+             level.nice.capacity()) *
+                sizeof(float) +
+            level.outline.capacity() * sizeof(std::vector<PointList>);
+    for (auto &loops : level.outline) {
+      size += loops.capacity() * sizeof(PointList);
+      for (auto &loop : loops) {
+        size += loop.capacity() * sizeof(Point);
+      }
+    }
+  }
+  return size;
+}
@@ -4,6 +4,7 @@
 #include "mapgen/Package.hpp"
 #include "mapgen/Region.hpp"
 #include "mapgen/Report.hpp"
+#include "mapgen/SpatialHash.hpp"
 #include "mapgen/names.hpp"
 #include "mapgen/utils.hpp"
 #include <cstring>
@@ -26,8 +27,8 @@ std::vector<T *> filterObjects(std::vector<T *> regions, filterFunc<T> filter,
   return places;
 }
 
-Simulator::Simulator(Map *m, int s) : map(m), _seed(s) {
-  _gen = new std::mt19937(_seed);
+Simulator::Simulator(Map *m, int s)
+    : map(m), _gen(mg::Random(s).stream(mg::SIMULATION_STREAM)), _seed(s) {
   vars = new EconomyVars();
   report = nullptr;
 }
@@ -203,7 +204,7 @@ void Simulator::economyTick(int y) {
   unsigned int gc = std::accumulate(goods->begin(), goods->end(), 0,
                             [](int s, Package *p2) { return s + p2->count; });
   // mg::info("Goods for sale:", gc);
-  std::shuffle(map->cities.begin(), map->cities.end(), *_gen);
+  std::shuffle(map->cities.begin(), map->cities.end(), _gen);
   unsigned int sn = 0;
   unsigned int ab = 0;
   for (auto c : map->cities) {
@@ -312,7 +313,7 @@ void Simulator::makeRoads() {
       map->roadMap.insert(std::make_pair(std::make_pair(c1, c3), shortRoad));
     }
   }
-  std::shuffle(map->roads.begin(), map->roads.end(), *_gen);
+  std::shuffle(map->roads.begin(), map->roads.end(), _gen);
 }
 
 void Simulator::makeCaves() {
@@ -330,7 +331,9 @@ void Simulator::makeCaves() {
       if (r->location != nullptr) {
         continue;
       }
-      Location *l = new Location(r, names::generateCityName(_gen), CAVE);
+      auto gen = _gen.stream(CAVE).stream(r->id);
+      Name name = map->namePool.take(names::generateCityName, gen);
+      Location *l = new Location(r, name, CAVE);
       map->locations.push_back(l);
       n--;
       i++;
@@ -401,22 +404,16 @@ void Simulator::removeBadPorts() {
 
 void Simulator::makeLighthouses() {
   map->status = "Make lighthouses...";
-  std::vector<Region *> cache;
+  SpatialHash cache(100);
   for (auto r : map->regions) {
     if (r->city != nullptr) {
       continue;
     }
-    bool tc = false;
-    for (auto cc : cache) {
-      if (mg::getDistance(r->site, cc->site) < 100) {
-        tc = true;
-      }
-    }
-    if (tc) {
+    if (cache.anyWithin(r->site, 100)) {
       continue;
     }
 
-    if (!r->megaCluster->isLand) {
+    if (!r->megaCluster->isLand || !r->isCoast()) {
       continue;
     }
     int i = 0;
@@ -426,9 +423,11 @@ void Simulator::makeLighthouses() {
       }
     }
     if (i >= 3) {
-      Location *l = new Location(r, names::generateCityName(_gen), LIGHTHOUSE);
+      auto gen = _gen.stream(LIGHTHOUSE).stream(r->id);
+      Name name = map->namePool.take(names::generateCityName, gen);
+      Location *l = new Location(r, name, LIGHTHOUSE);
       map->locations.push_back(l);
-      cache.push_back(l->region);
+      cache.insert(l->region);
     }
   }
 }
@@ -513,7 +512,9 @@ void Simulator::makeForts() {
 
       int n = 0;
       while (n < std::min(2, int(regions.size()))) {
-        City *c = new City(regions[n], names::generateCityName(_gen), FORT);
+        auto gen = _gen.stream(FORT).stream(regions[n]->id);
+        Name name = map->namePool.take(names::generateCityName, gen);
+        City *c = new City(regions[n], name, FORT);
         for (auto oc : map->cities) {
           auto road = makeRoad(map, c, oc);
           if (road == nullptr) {
@@ -533,6 +534,6 @@ void Simulator::makeForts() {
 
 template <typename Iter> Iter Simulator::select_randomly(Iter start, Iter end) {
   std::uniform_int_distribution<> dis(0, std::distance(start, end) - 1);
-  std::advance(start, dis(*_gen));
+  std::advance(start, dis(_gen));
   return start;
 }
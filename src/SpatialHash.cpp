@@ -0,0 +1,59 @@
+#include "mapgen/SpatialHash.hpp"
+#include <cmath>
+
+SpatialHash::SpatialHash(float cellSize) : _cellSize(cellSize) {}
+
+int SpatialHash::cell(float v) const {
+  return int(std::floor(v / _cellSize));
+}
+
+long long SpatialHash::key(int cx, int cy) const {
+  // Shift unsigned: cx is negative left of the map, where a signed shift
+  // is undefined.
+  return (long long)((unsigned long long)(unsigned int)(cx) << 32 |
+                     (unsigned int)(cy));
+}
+
+void SpatialHash::insert(Region *r) {
+  _cells[key(cell(r->site->x), cell(r->site->y))].push_back(r);
+  _count++;
+}
+
+// Calls f for every region closer than radius until it returns true.
+template <typename F>
+bool SpatialHash::visit(Point p, float radius, F f) const {
+  int x0 = cell(p->x - radius);
+  int x1 = cell(p->x + radius);
+  int y0 = cell(p->y - radius);
+  int y1 = cell(p->y + radius);
+  double r2 = double(radius) * radius;
+  for (int cx = x0; cx <= x1; cx++) {
+    for (int cy = y0; cy <= y1; cy++) {
+      auto it = _cells.find(key(cx, cy));
+      if (it == _cells.end()) {
+        continue;
+      }
+      for (auto r : it->second) {
+        double dx = r->site->x - p->x;
+        double dy = r->site->y - p->y;
+        if (dx * dx + dy * dy < r2 && f(r)) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool SpatialHash::anyWithin(Point p, float radius) const {
+  return visit(p, radius, [](Region *) { return true; });
+}
+
+std::vector<Region *> SpatialHash::within(Point p, float radius) const {
+  std::vector<Region *> regions;
+  visit(p, radius, [&](Region *r) {
+    regions.push_back(r);
+    return false;
+  });
+  return regions;
+}
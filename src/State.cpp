@@ -1,5 +1,5 @@
 #include "mapgen/State.hpp"
 
-State::State(std::string n, Cell* c) : name(n), cell(c) {
+State::State(Name n, Region* c) : name(n), capital(c) {
   
 }
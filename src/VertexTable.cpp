@@ -0,0 +1,89 @@
+#include "mapgen/VertexTable.hpp"
+#include "mapgen/Region.hpp"
+#include <unordered_map>
+
+void VertexTable::build(std::vector<Cell *> &cells) {
+  points.clear();
+  cellStart.clear();
+  cellVertices.clear();
+  cellStart.reserve(cells.size() + 1);
+  cellVertices.reserve(cells.size() * 6);
+
+  std::unordered_map<Point, int> index;
+  index.reserve(cells.size() * 2);
+  for (auto c : cells) {
+    cellStart.push_back(int(cellVertices.size()));
+    if (c == nullptr) {
+      continue;
+    }
+    for (auto he : c->halfEdges) {
+      Point p = he->startPoint();
+      auto it = index.find(p);
+      if (it == index.end()) {
+        it = index.insert(std::make_pair(p, int(points.size()))).first;
+        points.push_back(p);
+      }
+      cellVertices.push_back(it->second);
+    }
+  }
+  cellStart.push_back(int(cellVertices.size()));
+
+  heights.assign(points.size(), 0.f);
+  humidity.assign(points.size(), 0.f);
+}
+
+// Every vertex gets the mean value of the regions sharing it.
+template <typename F>
+static void spread(std::vector<Region *> &regions, std::vector<float> &field,
+                   size_t size, F value) {
+  std::vector<int> count(size, 0);
+  field.assign(size, 0.f);
+  for (auto r : regions) {
+    for (int i = 0; i < r->getVertexCount(); i++) {
+      int v = r->getVertexId(i);
+      field[v] += value(r);
+      count[v]++;
+    }
+  }
+  for (size_t v = 0; v < size; v++) {
+    if (count[v] != 0) {
+      field[v] /= count[v];
+    }
+  }
+}
+
+void VertexTable::spreadHumidity(std::vector<Region *> &regions) {
+  spread(regions, humidity, points.size(),
+         [](Region *r) { return r->humidity; });
+}
+
+void VertexTable::spreadCoastDistance(std::vector<Region *> &regions) {
+  spread(regions, coastDistance, points.size(),
+         [](Region *r) { return r->coastDistance; });
+}
+
+void VertexTable::shiftHeights(std::vector<Region *> &regions,
+                               const std::vector<float> &delta) {
+  std::vector<int> count(points.size(), 0);
+  std::vector<float> shift(points.size(), 0.f);
+  for (auto r : regions) {
+    for (int i = 0; i < r->getVertexCount(); i++) {
+      int v = r->getVertexId(i);
+      shift[v] += delta[r->id];
+      count[v]++;
+    }
+  }
+  for (size_t v = 0; v < points.size(); v++) {
+    if (count[v] != 0) {
+      heights[v] += shift[v] / count[v];
+    }
+  }
+}
+
+size_t VertexTable::memoryUsage() {
+  return points.capacity() * sizeof(Point) +
+         (heights.capacity() + humidity.capacity() +
+          coastDistance.capacity()) *
+             sizeof(float) +
+         (cellStart.capacity() + cellVertices.capacity()) * sizeof(int);
+}
@@ -1,105 +1,166 @@
+#include <algorithm>
+#include <cmath>
 #include "mapgen/WeatherManager.hpp"
+#include "mapgen/Diffusion.hpp"
 
 WeatherManager::WeatherManager() {}
 
 
-void WeatherManager::genWind() {
-  windForce = rand() / (double)RAND_MAX;
-  windAngle = rand() / (double)RAND_MAX * 270;
+void WindLayer::build(const std::vector<Region *> &regions) {
+  from.assign(regions.size(), -1);
+  weight.assign(regions.size(), 0.f);
+  mg::parallelFor(int(regions.size()), [&](int i) {
+    Region *region = regions[i];
+    if (!region->cluster->isLand) {
+      return;
+    }
+    auto r2 = region->getRegionWithDirection(angle, force);
+    if (r2 != nullptr) {
+      from[i] = r2->id;
+      weight[i] = force;
+    }
+  });
 }
 
+void WeatherManager::genWind(const std::vector<Region *> &regions,
+                             mg::Random gen) {
+  windForce = gen.uniform();
+  windAngle = gen.uniform() * 270;
+  temperature = meanTemperature;
+  season = 0;
+  seasonWinds.clear();
+  winds.clear();
+  addWind(regions, windAngle, windForce);
+}
 
-void WeatherManager::calcTemp(std::vector<Region*> regions) {
-  for (auto r : regions) {
+void WeatherManager::advanceSeason(const std::vector<Region *> &regions) {
+  season++;
+  int step = season % seasonsPerYear;
+  float phase = std::sin(2.f * float(M_PI) * step / seasonsPerYear);
+  temperature = meanTemperature + seasonalSwing * phase;
+
+  // One wind table per season of the year, built the first time it comes.
+  seasonWinds.resize(seasonsPerYear);
+  WindLayer &layer = seasonWinds[step];
+  if (layer.from.size() != regions.size()) {
+    layer.angle = windAngle + seasonalTurn * phase;
+    layer.force = windForce;
+    layer.build(regions);
+  }
+  winds.assign(1, layer);
+}
+
+void WeatherManager::addWind(const std::vector<Region *> &regions,
+                             float angle, float force) {
+  WindLayer layer;
+  layer.angle = angle;
+  layer.force = force;
+  layer.build(regions);
+  winds.push_back(std::move(layer));
+}
+
+
+// Every region becomes the mean of its neighbours, counting itself as one
+// more sample that contributes nothing (kept from the original weights).
+static float smoothKernel(int, NeighborRange ns,
+                          const std::vector<float> &field) {
+  float h = 0.f;
+  for (int n : ns) {
+    h += field[n];
+  }
+  return h / float(ns.size() + 1);
+}
+
+// Land regions take a share of the field from the region upwind, one
+// wind layer after another. Each layer reads only the previous field.
+std::vector<float> WeatherManager::blow(const std::vector<float> &field,
+                                        float loss) {
+  std::vector<float> prev(field);
+  std::vector<float> next(field.size());
+  for (auto &layer : winds) {
+    mg::parallelFor(int(prev.size()), [&](int i) {
+      next[i] = prev[i];
+      int from = layer.from[i];
+      if (from == -1) {
+        return;
+      }
+      float upwind = prev[from];
+      if (upwind > prev[i]) {
+        next[i] += layer.weight[i] * upwind;
+      } else {
+        next[i] -= loss * layer.weight[i] * upwind;
+      }
+    });
+    prev.swap(next);
+  }
+  return prev;
+}
+
+void WeatherManager::calcTemp(const std::vector<Region *> &regions,
+                              const RegionGraph &graph) {
+  std::vector<float> temp(regions.size());
+  mg::parallelFor(int(regions.size()), [&](int i) {
+    Region *r = regions[i];
     // TODO: adjust it
-    r->temperature = temperature - (temperature / 5 * r->humidity) -
-                     (temperature / 1.2 * r->getHeight(r->site));
+    temp[i] = temperature - (temperature / 5 * r->humidity) -
+              (temperature / 1.2 * r->getHeight(r->site));
     for (auto n : r->neighbors) {
       if (n->biom == biom::LAKE) {
-        r->temperature += 2;
-        r->biom.feritlity += 0.2f;
+        temp[i] += 2;
       }
     }
-  }
+  });
 
-    for (Region *region : regions) {
-      if (!region->cluster->isLand) continue;
-      auto r2 = region->getRegionWithDirection(windAngle, windForce);
-      if (r2 != nullptr) {
-        if (r2->temperature > region->temperature) {
-          region->temperature += windForce * r2->temperature;
-        } else {
-          region->temperature -= 1 * windForce * r2->temperature;
-        }
-      }
-    }
-    for (Region *region : regions) {
-      auto i = 1;
-      auto h = 0.f;
-      for (auto n: region->neighbors) {
-        h += n->temperature;
-        i++;
-      }
-      region->temperature = h/float(i);
-    }
+  temp = blow(temp, 1.f);
+  mg::stencil(graph, temp, smoothSweeps, smoothKernel);
+  for (Region *region : regions) {
+    region->temperature = temp[region->id];
+  }
 }
 
-void WeatherManager::calcHumidity(std::vector<Region*> regions) {
-  for (auto r : regions) {
-    r->humidity = biom::DEFAULT_HUMIDITY;
+void WeatherManager::calcHumidity(const std::vector<Region *> &regions,
+                                  const RegionGraph &graph) {
+  // Sea is a fixed source of moisture. Land holds its own moisture with
+  // weight retention and pulls in the rest from its neighbours.
+  DiffusionSystem system;
+  system.resize(graph);
+  system.retention = retention;
+  mg::parallelFor(int(regions.size()), [&](int i) {
+    Region *r = regions[i];
     if (!r->megaCluster->isLand) {
-      r->humidity = 1;
-      continue;
+      system.source[i] = 1;
+      system.fixed[i] = 1;
+      return;
     }
+    float source = biom::DEFAULT_HUMIDITY;
     if (r->hasRiver) {
-      r->humidity += 0.2f;
+      source += std::min(0.3f, 0.2f * std::sqrt(r->discharge));
     }
-  }
-
-  auto calcRegionsHum = [&]() {
-    for (auto r : regions) {
-      if (!r->megaCluster->isLand || r->humidity >= 0.9) {
-        continue;
-      }
-      for (auto rn : r->neighbors) {
-        if (rn->hasRiver || rn->biom == biom::LAKE) {
-          r->humidity += 0.05f;
-        }
-        float hd = rn->getHeight(rn->site) - r->getHeight(r->site);
-        if (rn->humidity > r->humidity && r->humidity != 1 && hd < 0.04) {
-          r->humidity += (rn->humidity - r->humidity) / (1.8f - (hd * 2));
-        }
+    float ht = r->getHeight(r->site);
+    for (int e = graph.offsets[i]; e < graph.offsets[i + 1]; e++) {
+      Region *rn = regions[graph.ids[e]];
+      if (rn->hasRiver || rn->biom == biom::LAKE) {
+        source += 0.05f;
       }
-      //r->humidity = std::min(0.9f, float(r->humidity));
-      r->humidity = float(r->humidity);
+      // Moisture hardly climbs onto higher ground.
+      float hd = rn->getHeight(rn->site) - ht;
+      system.weights[e] = hd < 0.04f ? 1.f / (1.8f - hd * 2) : 0.f;
     }
-  };
+    system.source[i] = source;
+  });
 
-  calcRegionsHum();
-  std::reverse(regions.begin(), regions.end());
-  calcRegionsHum();
-  std::reverse(regions.begin(), regions.end());
-
-
-    for (Region *region : regions) {
-      if (!region->cluster->isLand) continue;
-      auto r2 = region->getRegionWithDirection(windAngle, windForce);
-      if (r2 != nullptr) {
-        if (r2->humidity > region->humidity) {
-          region->humidity += windForce * r2->humidity;
-        } else {
-          region->humidity -= 0.2 * windForce * r2->humidity;
-        }
-      }
-    }
+  // Coarse levels aggregate by the land/sea flag, so no coarse node mixes
+  // land and sea regions.
+  std::vector<int> land(regions.size());
+  for (auto r : regions) {
+    land[r->id] = r->megaCluster->isLand ? 1 : 0;
+  }
+  std::vector<float> humidity(system.source);
+  system.solveMultigrid(graph, humidity, land, cycles, epsilon);
 
-    for (Region *region : regions) {
-      auto i = 1;
-      auto h = 0.f;
-      for (auto n: region->neighbors) {
-        h += n->humidity;
-        i++;
-      }
-      region->humidity = h/float(i);
-    }
+  humidity = blow(humidity, 0.2f);
+  mg::stencil(graph, humidity, smoothSweeps, smoothKernel);
+  for (Region *region : regions) {
+    region->humidity = humidity[region->id];
+  }
 }
@@ -28,31 +28,97 @@ const std::string _city_second_names[] = {"acre","band","barrow","bay","bell","b
 std::vector<std::string> city_first_names (_city_first_names, _city_first_names + sizeof(_city_first_names) / sizeof(_city_first_names[0]) );
 std::vector<std::string> city_second_names (_city_second_names, _city_second_names + sizeof(_city_second_names) / sizeof(_city_second_names[0]) );
 
+const std::string _state_second_names[] = {"Empire","Kingdom","Lands","Republic","Principality","Duchy","Dominion","Realm","Union","Confederacy","Marches","Protectorate"};
+
+std::vector<std::string> state_second_names (_state_second_names, _state_second_names + sizeof(_state_second_names) / sizeof(_state_second_names[0]) );
+
 namespace names {
-  template<typename Iter>
-  Iter select_randomly(Iter start, Iter end, std::mt19937 *gen) {
-    std::uniform_int_distribution<> dis(0, std::distance(start, end) - 1);
-    std::advance(start, dis(*gen));
-    return start;
+  static uint16_t pick(const std::vector<std::string> &words,
+                       mg::Random &gen) {
+    std::uniform_int_distribution<> dis(0, int(words.size()) - 1);
+    return uint16_t(dis(gen));
   }
 
-  std::string generateRiverName(std::mt19937 *gen) {
-    std::string fn = *select_randomly(river_first_names.begin(), river_first_names.end(), gen);
-    std::string sn = *select_randomly(river_second_names.begin(), river_second_names.end(), gen);
-    return fn+" "+sn;
+  Name generateRiverName(mg::Random &gen) {
+    Name name;
+    name.kind = RIVER_NAME;
+    name.first = pick(river_first_names, gen);
+    name.second = pick(river_second_names, gen);
+    return name;
   }
 
-  std::string generateLandName(std::mt19937 *gen) {
-    return *select_randomly(island_first_names.begin(), island_first_names.end(), gen) + " " + *select_randomly(island_second_names.begin(), island_second_names.end(), gen);
-    }
+  Name generateLandName(mg::Random &gen) {
+    Name name;
+    name.kind = LAND_NAME;
+    name.first = pick(island_first_names, gen);
+    name.second = pick(island_second_names, gen);
+    return name;
+  }
 
-  std::string generateSeaName(std::mt19937 *gen) {
-    return *select_randomly(sea_first_names.begin(), sea_first_names.end(), gen) + " " + *select_randomly(sea_second_names.begin(), sea_second_names.end(), gen);
+  Name generateSeaName(mg::Random &gen) {
+    Name name;
+    name.kind = SEA_NAME;
+    name.first = pick(sea_first_names, gen);
+    name.second = pick(sea_second_names, gen);
+    return name;
   }
 
-  std::string generateCityName(std::mt19937 *gen) {
-    auto name = *select_randomly(city_first_names.begin(), city_first_names.end(), gen)  + *select_randomly(city_second_names.begin(), city_second_names.end(), gen);
-    name[0] = toupper(name[0]);
+  Name generateCityName(mg::Random &gen) {
+    Name name;
+    name.kind = CITY_NAME;
+    name.first = pick(city_first_names, gen);
+    name.second = pick(city_second_names, gen);
     return name;
   }
+
+  Name generateStateName(mg::Random &gen) {
+    Name name = generateCityName(gen);
+    name.kind = STATE_NAME;
+    name.third = pick(state_second_names, gen);
+    return name;
+  }
+}
+
+std::string Name::str() const {
+  std::string city;
+  switch (kind) {
+  case NO_NAME:
+    break;
+  case RIVER_NAME:
+    return river_first_names[first] + " " + river_second_names[second];
+  case LAND_NAME:
+    return island_first_names[first] + " " + island_second_names[second];
+  case SEA_NAME:
+    return sea_first_names[first] + " " + sea_second_names[second];
+  case CITY_NAME:
+  case STATE_NAME:
+    city = city_first_names[first] + city_second_names[second];
+    city[0] = toupper(city[0]);
+    if (kind == STATE_NAME) {
+      city += " " + state_second_names[third];
+    }
+    return city;
+  }
+  return "";
+}
+
+std::ostream &operator<<(std::ostream &strm, const Name &n) {
+  return strm << n.str();
+}
+
+Name NamePool::take(Name (*draw)(mg::Random &), mg::Random &gen) {
+  Name name;
+  for (int i = 0; i < 16; i++) {
+    name = draw(gen);
+    if (_used.insert(name.key()).second) {
+      break;
+    }
+  }
+  return name;
+}
+
+size_t NamePool::memoryUsage() const {
+  // Every node holds the key and the next pointer, plus one bucket slot.
+  return _used.size() * (sizeof(uint64_t) + sizeof(void *)) +
+         _used.bucket_count() * sizeof(void *);
 }